@@ -0,0 +1,408 @@
+#include "iscreate/iscreate.hpp"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+      /* One measured operation on one synthetic instruction set */
+      struct result {
+            std::size_t instructions = 0u;
+            std::string layout = "";
+            std::string operation = "";
+            std::string language = "";
+            std::size_t runs = 0u;
+            double median_ns = 0.0;
+            double min_ns = 0.0;
+            std::size_t bytes = 0u; /* Output size of save and represent, 0 otherwise. */
+            std::size_t peak_bytes = 0u;      /* Heap high-water mark during the operation above the heap held when it started. */
+            std::int64_t retained_bytes = 0; /* Heap held after the operation minus the heap held before it. */
+      };
+
+      struct options {
+            std::size_t max = 1000000u;
+            std::size_t repeat = 5u;
+            bool csv = false;
+            std::string out = "";
+      };
+
+      /* Heap held by the program and its high-water mark since the last reset, kept by the operator new below. */
+      std::atomic<std::size_t> heap_live{0u};
+      std::atomic<std::size_t> heap_peak{0u};
+#if defined(ISCREATE_STATS)
+      thread_local std::uint64_t allocations = 0u; /* Read by the library's phase stats through set_allocation_counter */
+#endif
+
+      /* Allocations are prefixed with their size in a header that keeps the requested alignment. */
+      void *allocate(const std::size_t size, const std::size_t align) {
+            const auto header = std::max(align, alignof(std::max_align_t));
+#ifdef _WIN32
+            auto *base = static_cast<unsigned char *>(align > alignof(std::max_align_t) ? _aligned_malloc(size + header, align) : std::malloc(size + header));
+#else
+            auto *base = static_cast<unsigned char *>(align > alignof(std::max_align_t) ? std::aligned_alloc(align, (size + header + align - 1u) / align * align) : std::malloc(size + header));
+#endif
+            if (base == nullptr) {
+                  throw std::bad_alloc();
+            }
+            std::memcpy(base + header - sizeof(std::size_t), &size, sizeof(std::size_t));
+#if defined(ISCREATE_STATS)
+            ++allocations;
+#endif
+            const auto live = heap_live.fetch_add(size, std::memory_order_relaxed) + size;
+            auto peak = heap_peak.load(std::memory_order_relaxed);
+            while (live > peak && !heap_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+            }
+            return base + header;
+      }
+
+      void deallocate(void *ptr, const std::size_t align) {
+            if (ptr == nullptr) {
+                  return;
+            }
+            const auto header = std::max(align, alignof(std::max_align_t));
+            auto *base = static_cast<unsigned char *>(ptr) - header;
+            std::size_t size = 0u;
+            std::memcpy(&size, base + header - sizeof(std::size_t), sizeof(std::size_t));
+            heap_live.fetch_sub(size, std::memory_order_relaxed);
+#ifdef _WIN32
+            if (align > alignof(std::max_align_t)) {
+                  _aligned_free(base);
+                  return;
+            }
+            std::free(base);
+#else
+            std::free(base);
+#endif
+            return;
+      }
+
+      /* Count of a command line option, false on anything but a whole non-negative number. */
+      bool parse_count(const char *str, std::size_t &out) {
+            const auto *end = str + std::strlen(str);
+            const auto result = std::from_chars(str, end, out);
+            return result.ec == std::errc() && result.ptr == end && result.ptr != str;
+      }
+
+      /* Operand lists are shared between instructions so building the input does not dominate memory. */
+      std::vector<std::vector<iscreate::operand>> create_operand_lists() {
+            const char *encodings[] = {"Mod", "Imm", "Rel"};
+            const char *sizes[] = {"8-Bits", "16-Bits", "32-Bits", "64-Bits"};
+            const char *kinds[] = {"register", "integer", "offset"};
+
+            std::vector<std::vector<iscreate::operand>> retn;
+            for (auto count = 0u; count < 4u; ++count) {
+                  for (auto variant = 0u; variant < 12u; ++variant) {
+                        std::vector<iscreate::operand> operands;
+                        for (auto idx = 0u; idx < count; ++idx) {
+                              const auto pick = variant + idx;
+                              operands.push_back(iscreate::create_operand("Op" + std::to_string(idx), encodings[pick % 3u], sizes[pick % 4u], "Synthetic operand", kinds[pick % 3u]));
+                        }
+                        retn.push_back(std::move(operands));
+                  }
+            }
+            return retn;
+      }
+
+      /* Dense opcodes are 0 to count - 1, sparse opcodes leave 7 unused slots after every instruction. Descending adds the same set highest opcode first. */
+      void fill(iscreate::instruction_set &set, const std::vector<std::string> &mnemonics, const std::vector<std::vector<iscreate::operand>> &lists, const std::size_t count, const bool sparse, const bool descending = false) {
+            for (std::size_t n = 0u; n < count; ++n) {
+                  const auto idx = descending ? count - 1u - n : n;
+                  set.add(static_cast<std::intptr_t>(sparse ? idx * 8u : idx), mnemonics[idx], "Synthetic instruction", lists[idx % lists.size()]);
+            }
+            return;
+      }
+
+      /* The instructions fill adds as opcode and instruction pairs, for add_bulk and rvalue adds. */
+      std::vector<std::pair<std::intptr_t, iscreate::instruction>> create_instructions(const std::vector<std::string> &mnemonics, const std::vector<std::vector<iscreate::operand>> &lists, const std::size_t count, const bool sparse) {
+            std::vector<std::pair<std::intptr_t, iscreate::instruction>> retn;
+            retn.reserve(count);
+            for (std::size_t idx = 0u; idx < count; ++idx) {
+                  retn.emplace_back(static_cast<std::intptr_t>(sparse ? idx * 8u : idx), iscreate::instruction{mnemonics[idx], "Synthetic instruction", lists[idx % lists.size()]});
+            }
+            return retn;
+      }
+
+      /* Time body repeat times, setup runs untimed before each run. */
+      template <typename setup_callable, typename body_callable>
+      result measure(const options &opts, const setup_callable &setup, const body_callable &body) {
+            std::vector<double> times;
+            result retn;
+            for (std::size_t run = 0u; run < opts.repeat; ++run) {
+                  setup();
+                  const auto before = heap_live.load(std::memory_order_relaxed);
+                  heap_peak.store(before, std::memory_order_relaxed);
+                  const auto start = std::chrono::steady_clock::now();
+                  retn.bytes = body();
+                  const auto stop = std::chrono::steady_clock::now();
+                  times.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+                  retn.peak_bytes = std::max(retn.peak_bytes, heap_peak.load(std::memory_order_relaxed) - before);
+                  retn.retained_bytes = static_cast<std::int64_t>(heap_live.load(std::memory_order_relaxed)) - static_cast<std::int64_t>(before);
+            }
+            std::sort(times.begin(), times.end());
+            retn.runs = times.size();
+            retn.median_ns = times[times.size() / 2u];
+            retn.min_ns = times.front();
+            return retn;
+      }
+
+      /* Every generator in one language, decoder style generators need opcodes up to 0xFFFF. The bulk decoder is left out, it needs one instruction width, and dispatch runs on its own mapped set. */
+      template <iscreate::language lang, typename record_callable>
+      void measure_represent(const options &opts, iscreate::instruction_set &set, const bool small, const std::string &language, const record_callable &record) {
+            const auto none = []() {};
+            const auto add = [&](const std::string &operation, result r) {
+                  r.language = language;
+                  record(operation, r);
+            };
+
+            add("represent", measure(opts, none, [&]() {
+                  const auto code = set.represent<lang>();
+                  return code.enum_opcodes.size() + code.enum_opencodings.size() + code.enum_opkinds.size() + code.opencodings.size() + code.opkinds.size() + code.opdescriptors.size();
+            }));
+            add("represent_enum_opcodes", measure(opts, none, [&]() { return set.represent_enum_opcodes<lang>().size(); }));
+            add("represent_enum_opencodings", measure(opts, none, [&]() { return set.represent_enum_opencodings<lang>().size(); }));
+            add("represent_enum_opkinds", measure(opts, none, [&]() { return set.represent_enum_opkinds<lang>().size(); }));
+            add("represent_opencodings", measure(opts, none, [&]() { return set.represent_opencodings<lang>().size(); }));
+            add("represent_opkinds", measure(opts, none, [&]() { return set.represent_opkinds<lang>().size(); }));
+            add("represent_opdescriptors", measure(opts, none, [&]() { return set.represent_opdescriptors<lang>().size(); }));
+            add("represent_opdescriptors_flat", measure(opts, none, [&]() { return set.represent_opdescriptors<lang, iscreate::table::flat>().size(); }));
+            add("represent_mnemonic_lookup", measure(opts, none, [&]() { return set.represent_mnemonic_lookup<lang>().size(); }));
+            if (small) {
+                  add("represent_decoder", measure(opts, none, [&]() { return set.represent_decoder<lang>().size(); }));
+                  add("represent_packed_operands", measure(opts, none, [&]() { return set.represent_packed_operands<lang>().size(); }));
+                  add("represent_encoder", measure(opts, none, [&]() { return set.represent_encoder<lang>().size(); }));
+                  add("represent_formatter", measure(opts, none, [&]() { return set.represent_formatter<lang>().size(); }));
+                  add("represent_interpreter", measure(opts, none, [&]() { return set.represent_interpreter<lang>().size(); }));
+                  add("represent_block_cache", measure(opts, none, [&]() { return set.represent_block_cache<lang>().size(); }));
+            }
+
+            return;
+      }
+
+      void write_csv(std::ostream &out, const std::vector<result> &results) {
+            out << "instructions,layout,operation,language,runs,median_ns,min_ns,instructions_per_second,bytes,bytes_per_second,peak_bytes,retained_bytes\n";
+            for (const auto &r : results) {
+                  const auto seconds = r.median_ns / 1e9;
+                  out << r.instructions << ',' << r.layout << ',' << r.operation << ',' << r.language << ',' << r.runs << ','
+                      << static_cast<std::uint64_t>(r.median_ns) << ',' << static_cast<std::uint64_t>(r.min_ns) << ','
+                      << static_cast<std::uint64_t>(seconds > 0.0 ? r.instructions / seconds : 0.0) << ',' << r.bytes << ','
+                      << static_cast<std::uint64_t>(seconds > 0.0 ? r.bytes / seconds : 0.0) << ',' << r.peak_bytes << ',' << r.retained_bytes << '\n';
+            }
+            return;
+      }
+
+      void write_json(std::ostream &out, const std::vector<result> &results) {
+            out << "{\"results\": [";
+            for (std::size_t idx = 0u; idx < results.size(); ++idx) {
+                  const auto &r = results[idx];
+                  const auto seconds = r.median_ns / 1e9;
+                  out << (idx != 0u ? ",\n" : "\n") << "  {\"instructions\": " << r.instructions << ", \"layout\": \"" << r.layout << "\", \"operation\": \"" << r.operation
+                      << "\", \"language\": \"" << r.language << "\", \"runs\": " << r.runs << ", \"median_ns\": " << static_cast<std::uint64_t>(r.median_ns)
+                      << ", \"min_ns\": " << static_cast<std::uint64_t>(r.min_ns) << ", \"instructions_per_second\": " << static_cast<std::uint64_t>(seconds > 0.0 ? r.instructions / seconds : 0.0)
+                      << ", \"bytes\": " << r.bytes << ", \"bytes_per_second\": " << static_cast<std::uint64_t>(seconds > 0.0 ? r.bytes / seconds : 0.0) << ", \"peak_bytes\": " << r.peak_bytes << ", \"retained_bytes\": " << r.retained_bytes << "}";
+            }
+            out << "\n]}\n";
+            return;
+      }
+
+} // namespace
+
+/* Replacing the global forms here counts every allocation the benchmark makes, the library itself replaces nothing. */
+void *operator new(std::size_t size) {
+      return allocate(size, alignof(std::max_align_t));
+}
+
+void *operator new[](std::size_t size) {
+      return allocate(size, alignof(std::max_align_t));
+}
+
+void *operator new(std::size_t size, std::align_val_t align) {
+      return allocate(size, static_cast<std::size_t>(align));
+}
+
+void *operator new[](std::size_t size, std::align_val_t align) {
+      return allocate(size, static_cast<std::size_t>(align));
+}
+
+void operator delete(void *ptr) noexcept {
+      deallocate(ptr, alignof(std::max_align_t));
+}
+
+void operator delete[](void *ptr) noexcept {
+      deallocate(ptr, alignof(std::max_align_t));
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+      deallocate(ptr, alignof(std::max_align_t));
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+      deallocate(ptr, alignof(std::max_align_t));
+}
+
+void operator delete(void *ptr, std::align_val_t align) noexcept {
+      deallocate(ptr, static_cast<std::size_t>(align));
+}
+
+void operator delete[](void *ptr, std::align_val_t align) noexcept {
+      deallocate(ptr, static_cast<std::size_t>(align));
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t align) noexcept {
+      deallocate(ptr, static_cast<std::size_t>(align));
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t align) noexcept {
+      deallocate(ptr, static_cast<std::size_t>(align));
+}
+
+/* Usage: benchmark [--csv] [--max instructions] [--repeat runs] [--out file] */
+std::int32_t main(std::int32_t argc, char **argv) {
+
+      options opts;
+      for (auto idx = 1; idx < argc; ++idx) {
+            const std::string arg = argv[idx];
+            if (arg == "--csv") {
+                  opts.csv = true;
+            } else if (arg == "--max" && idx + 1 < argc && parse_count(argv[idx + 1], opts.max)) {
+                  ++idx;
+            } else if (arg == "--repeat" && idx + 1 < argc && parse_count(argv[idx + 1], opts.repeat) && opts.repeat != 0u) {
+                  ++idx;
+            } else if (arg == "--out" && idx + 1 < argc) {
+                  opts.out = argv[++idx];
+            } else {
+                  std::cerr << "Usage: benchmark [--csv] [--max instructions] [--repeat runs] [--out file]" << std::endl;
+                  return 1;
+            }
+      }
+
+#if defined(ISCREATE_STATS)
+      iscreate::set_allocation_counter([]() { return allocations; });
+#endif
+
+      /* Build the inputs once for the largest set */
+      const auto lists = create_operand_lists();
+      std::vector<std::string> mnemonics;
+      const std::size_t counts[] = {100u, 1000u, 10000u, 100000u, 1000000u};
+      mnemonics.reserve(opts.max);
+      for (std::size_t idx = 0u; idx < opts.max; ++idx) {
+            mnemonics.push_back("i" + std::to_string(idx));
+      }
+
+      std::vector<result> results;
+      const std::string dir = "benchmark.json";
+      for (const auto count : counts) {
+            if (count > opts.max) {
+                  break;
+            }
+            for (const auto sparse : {false, true}) {
+                  const auto case_result = [&](const std::string &operation, result r) {
+                        r.instructions = count;
+                        r.layout = sparse ? "sparse" : "dense";
+                        r.operation = operation;
+                        results.push_back(r);
+                  };
+
+                  iscreate::instruction_set set("benchmark");
+                  case_result("add", measure(opts, [&]() { set.clear(); }, [&]() {
+                        fill(set, mnemonics, lists, count, sparse);
+                        return std::size_t(0u);
+                  }));
+                  /* Out of order adds, the first lookup pays for ordering and indexing them. */
+                  case_result("add_descending", measure(opts, [&]() { set.clear(); }, [&]() {
+                        fill(set, mnemonics, lists, count, sparse, true);
+                        set.with_mnemonic(mnemonics.front());
+                        return std::size_t(0u);
+                  }));
+
+                  /* Prebuilt instructions, rebuilt before each run as the rvalue cases move their strings out. */
+                  std::vector<std::pair<std::intptr_t, iscreate::instruction>> input;
+                  const auto prepare = [&]() {
+                        set.clear();
+                        input.clear();
+                        input = create_instructions(mnemonics, lists, count, sparse);
+                  };
+                  case_result("add_rvalue", measure(opts, prepare, [&]() {
+                        for (auto &entry : input) {
+                              set.add(entry.first, std::move(entry.second));
+                        }
+                        return std::size_t(0u);
+                  }));
+                  case_result("add_bulk", measure(opts, prepare, [&]() {
+                        set.add_bulk(input);
+                        return std::size_t(0u);
+                  }));
+                  case_result("add_bulk_rvalue", measure(opts, prepare, [&]() {
+                        set.add_bulk(std::move(input));
+                        return std::size_t(0u);
+                  }));
+                  std::vector<std::pair<std::intptr_t, iscreate::instruction>>().swap(input);
+
+                  case_result("save", measure(opts, []() {}, [&]() {
+                        set.save(dir);
+                        return static_cast<std::size_t>(std::ifstream(dir, std::ios::binary | std::ios::ate).tellg());
+                  }));
+                  case_result("data", measure(opts, []() {}, [&]() {
+                        const auto copy = set.data();
+                        return std::size_t(0u);
+                  }));
+                  case_result("clear", measure(opts, [&]() { fill(set, mnemonics, lists, count, sparse); }, [&]() {
+                        set.clear();
+                        return std::size_t(0u);
+                  }));
+                  case_result("load", measure(opts, [&]() { set.clear(); }, [&]() {
+                        set.load(dir);
+                        return std::size_t(0u);
+                  }));
+                  std::remove(dir.c_str());
+
+                  const auto small = (sparse ? (count - 1u) * 8u : count - 1u) <= 0xFFFFu;
+                  measure_represent<iscreate::language::cpp>(opts, set, small, "cpp", case_result);
+                  measure_represent<iscreate::language::c>(opts, set, small, "c", case_result);
+            }
+
+            /* Dispatch needs every opcode in an opcode map, instruction idx is byte idx % 256 of map 1 + idx / 256. */
+            if (count <= 0xFFu * 0x100u) {
+                  iscreate::instruction_set set("benchmark");
+                  for (std::size_t map = 0u; map * 0x100u < count; ++map) {
+                        set.opcode_maps.push_back({static_cast<std::uint8_t>(map + 1u)});
+                  }
+                  for (std::size_t idx = 0u; idx < count; ++idx) {
+                        set.add(static_cast<std::intptr_t>((idx / 0x100u + 1u) << 8u | idx % 0x100u), mnemonics[idx], "Synthetic instruction", lists[idx % lists.size()]);
+                  }
+                  const auto mapped_result = [&](const std::string &language, result r) {
+                        r.instructions = count;
+                        r.layout = "mapped";
+                        r.operation = "represent_dispatch";
+                        r.language = language;
+                        results.push_back(r);
+                  };
+                  mapped_result("cpp", measure(opts, []() {}, [&]() { return set.represent_dispatch<iscreate::language::cpp>().size(); }));
+                  mapped_result("c", measure(opts, []() {}, [&]() { return set.represent_dispatch<iscreate::language::c>().size(); }));
+            }
+      }
+
+      if (opts.out.empty()) {
+            opts.csv ? write_csv(std::cout, results) : write_json(std::cout, results);
+            return 0;
+      }
+
+      std::ofstream out(opts.out, std::ios::binary);
+      if (!out.is_open()) {
+            std::cerr << "Failed to open " + opts.out + "." << std::endl;
+            return 1;
+      }
+      opts.csv ? write_csv(out, results) : write_json(out, results);
+
+      return 0;
+}
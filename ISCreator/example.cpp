@@ -1,4 +1,5 @@
 #include "iscreate/iscreate.hpp"
+#include "iscreate/static_set.hpp"
 #include <iostream>
 
 std::int32_t main() {
@@ -35,6 +36,23 @@ std::int32_t main() {
       std::cout << "\n\Descriptor: \n"
                 << is.represent_opdescriptors() << std::endl;
 
+      /* Stream the decoder straight to stdout instead of building a string */
+      std::cout << "\n\nDecoder: \n";
+      {
+            auto out = iscreate::create_sink(std::cout);
+            is.represent_decoder(out);
+      }
+      std::cout << std::endl;
+
+      /* Same instruction set defined at compile time, its tables are constants. */
+      constexpr auto fixed = iscreate::create_static_set(
+          iscreate::static_instruction(0, "nop", "Nothing operation"),
+          iscreate::static_instruction(1, "move", "Move an integer to an register.", iscreate::static_operand{"Dest", "Mod", "8-Bits", "Register", "register"}, iscreate::static_operand{"Source", "Mod", "8-Bits", "Integer", "integer"}));
+      static_assert(fixed.opcode_of("move") == 1);
+
+      /* Check the compile time tables against the loaded set */
+      std::cout << "Compile time tables conform: " << (iscreate::conforms(fixed, is) ? "yes" : "no") << std::endl;
+
       std::cin.get();
 
       return 0;
@@ -0,0 +1,174 @@
+#include "batch.hpp"
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+      /* Every artifact of set in one pass */
+      template <iscreate::language lang>
+      iscreate::artifacts generate(iscreate::instruction_set &set, const iscreate::table mode) {
+            switch (mode) {
+                  case iscreate::table::flat: {
+                        return set.represent<lang, iscreate::table::flat>();
+                  }
+                  default: {
+                        return set.represent<lang, iscreate::table::map>();
+                  }
+            }
+      }
+
+      /* Write the generated code of set for lang to prefix.hpp or prefix.h */
+      bool write(iscreate::instruction_set &set, const iscreate::language lang, const iscreate::table mode, const std::string &prefix) {
+
+            iscreate::artifacts code;
+            std::string dir = prefix;
+            std::string header = "";
+            switch (lang) {
+                  case iscreate::language::cpp: {
+                        code = generate<iscreate::language::cpp>(set, mode);
+                        dir += ".hpp";
+                        header = "#pragma once\n#include <cstddef>\n#include <map>\n#include <vector>\n";
+                        break;
+                  }
+                  case iscreate::language::c: {
+                        code = generate<iscreate::language::c>(set, mode);
+                        dir += ".h";
+                        header = "#pragma once\n#include <stddef.h>\n";
+                        break;
+                  }
+                  default: {
+                        break;
+                  }
+            }
+
+            std::ofstream file(dir, std::ios::binary);
+            if (!file.is_open()) {
+                  std::cerr << "Failed to open " + dir + "." << std::endl;
+                  return false;
+            }
+
+            auto out = iscreate::create_sink(file);
+            out.append(header);
+            for (const auto *artifact : {&code.enum_opcodes, &code.enum_opencodings, &code.enum_opkinds, &code.opencodings, &code.opkinds, &code.opdescriptors}) {
+                  if (!artifact->empty()) {
+                        out.append("\n").append(*artifact).append("\n");
+                  }
+            }
+            out.flush();
+
+            return file.good();
+      }
+
+} // namespace
+
+iscreate::thread_pool::thread_pool(const std::size_t threads) {
+      const auto count = threads != 0u ? threads : std::max(1u, std::thread::hardware_concurrency());
+      this->workers.reserve(count - 1u);
+      for (auto idx = 1u; idx < count; ++idx) {
+            this->workers.emplace_back(&thread_pool::work, this);
+      }
+}
+
+iscreate::thread_pool::~thread_pool() {
+      {
+            std::lock_guard<std::mutex> guard(this->lock);
+            this->stop = true;
+      }
+      this->wake.notify_all();
+      for (auto &worker : this->workers) {
+            worker.join();
+      }
+}
+
+void iscreate::thread_pool::run(const std::size_t tasks, const std::function<void(std::size_t)> &task) {
+
+      /* Nothing */
+      if (tasks == 0u) {
+            return;
+      }
+
+      /* Publish the tasks, workers pick them up on the generation change. */
+      {
+            std::lock_guard<std::mutex> guard(this->lock);
+            this->task = &task;
+            this->tasks = tasks;
+            this->next = 0u;
+            this->active = this->workers.size();
+            ++this->generation;
+      }
+      this->wake.notify_all();
+
+      /* The caller works too */
+      for (auto idx = this->next++; idx < tasks; idx = this->next++) {
+            task(idx);
+      }
+
+      std::unique_lock<std::mutex> guard(this->lock);
+      this->done.wait(guard, [this]() { return this->active == 0u; });
+      this->task = nullptr;
+
+      return;
+}
+
+void iscreate::thread_pool::work() {
+
+      std::uint64_t seen = 0u;
+      std::unique_lock<std::mutex> guard(this->lock);
+      for (;;) {
+            this->wake.wait(guard, [&]() { return this->stop || this->generation != seen; });
+            if (this->stop) {
+                  return;
+            }
+            seen = this->generation;
+            const auto &task = *this->task;
+            const auto tasks = this->tasks;
+            guard.unlock();
+
+            for (auto idx = this->next++; idx < tasks; idx = this->next++) {
+                  task(idx);
+            }
+
+            guard.lock();
+            if (--this->active == 0u) {
+                  this->done.notify_all();
+            }
+      }
+}
+
+std::size_t iscreate::batch::run() {
+
+      /* Nothing */
+      if (this->jobs.empty() || this->languages.empty()) {
+            return 0u;
+      }
+
+      /* Parse every spec concurrently, a deque keeps sets in place while they load. */
+      std::deque<instruction_set> sets;
+      for (const auto &job : this->jobs) {
+            sets.emplace_back(job.spec);
+      }
+      std::vector<std::uint8_t> loaded(this->jobs.size(), 0u);
+      this->pool.run(this->jobs.size(), [&](const std::size_t idx) {
+            loaded[idx] = sets[idx].try_load(this->jobs[idx].spec) ? 1u : 0u;
+      });
+
+      /* A spec that failed to load would only give a partial output, its files are left as they are. */
+      for (std::size_t idx = 0u; idx < this->jobs.size(); ++idx) {
+            if (!loaded[idx]) {
+                  std::cerr << "Skipped " + this->jobs[idx].prefix + ", " + this->jobs[idx].spec + " failed to load." << std::endl;
+            }
+      }
+
+      /* Generate and write one output per spec and language, generation only reads the set and records stats atomically. */
+      const auto per = this->languages.size();
+      std::vector<std::uint8_t> written(this->jobs.size() * per, 0u);
+      this->pool.run(written.size(), [&](const std::size_t idx) {
+            if (loaded[idx / per]) {
+                  written[idx] = write(sets[idx / per], this->languages[idx % per], this->mode, this->jobs[idx / per].prefix) ? 1u : 0u;
+            }
+      });
+
+      return static_cast<std::size_t>(std::count(written.begin(), written.end(), 1u));
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "iscreate.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace iscreate {
+
+      /* Fixed set of worker threads running indexed tasks, indices are handed out from a shared counter. */
+      class thread_pool {
+
+          public:
+            /* 0 threads uses every hardware thread */
+            thread_pool(std::size_t threads = 0u);
+
+            thread_pool(const thread_pool &) = delete;
+            thread_pool &operator=(const thread_pool &) = delete;
+
+            ~thread_pool();
+
+            /* Run task(0) to task(tasks - 1) across the pool and the calling thread, returns once all are done. */
+            void run(std::size_t tasks, const std::function<void(std::size_t)> &task);
+
+            /* Threads taking part in run, including the caller */
+            std::size_t size() const {
+                  return this->workers.size() + 1u;
+            }
+
+          private:
+            void work();
+
+            std::vector<std::thread> workers;
+            std::mutex lock;
+            std::condition_variable wake;
+            std::condition_variable done;
+            const std::function<void(std::size_t)> *task = nullptr;
+            std::size_t tasks = 0u;
+            std::atomic<std::size_t> next{0u};
+            std::size_t active = 0u;
+            std::uint64_t generation = 0u;
+            bool stop = false;
+      };
+
+      /* Loads many instruction set specs and generates their code in parallel. */
+      class batch {
+
+          public:
+            batch(std::size_t threads = 0u)
+                : pool(threads) {
+            }
+
+            /* Queue spec, its code is written to prefix.hpp for C++ and prefix.h for C. A prefix already queued is rejected. */
+            void add(const std::string &spec, const std::string &prefix) {
+                  if (!this->prefixes.insert(prefix).second) {
+                        std::cerr << "Prefix " + prefix + " is already used, " + spec + " is not queued." << std::endl;
+                        return;
+                  }
+                  this->jobs.push_back({spec, prefix});
+                  return;
+            }
+
+            /* Load every spec, then generate and write every output of the specs that loaded. Returns the number of files written. */
+            std::size_t run();
+
+            std::size_t threads() const {
+                  return this->pool.size();
+            }
+
+            void clear() {
+                  this->jobs.clear();
+                  this->prefixes.clear();
+                  return;
+            }
+
+            /* Languages to generate, output for each spec does not depend on thread count or scheduling. */
+            std::vector<language> languages = {language::cpp, language::c};
+            table mode = table::map;
+
+          private:
+            struct job {
+                  std::string spec = "";
+                  std::string prefix = "";
+            };
+
+            std::vector<job> jobs;
+            std::unordered_set<std::string> prefixes; /* Two jobs writing the same files would race */
+            thread_pool pool;
+      };
+
+} // namespace iscreate
@@ -0,0 +1,108 @@
+#include "cache.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+iscreate::write_result iscreate::write_if_changed(const std::string &dir, const std::string &contents) {
+
+      /* Compare against what is on disk, the mapping is closed again before writing. */
+      {
+            const mapped_file file(dir);
+            if (file.is_open() && file.size() == contents.size() && (contents.empty() || std::memcmp(file.data(), contents.data(), contents.size()) == 0)) {
+                  return write_result::unchanged;
+            }
+      }
+
+      std::ofstream out(dir, std::ios::binary);
+      if (!out.is_open()) {
+            std::cerr << "Failed to open " + dir + "." << std::endl;
+            return write_result::failed;
+      }
+      out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+      out.close();
+      if (!out) {
+            std::cerr << "Failed to write " + dir + "." << std::endl;
+            return write_result::failed;
+      }
+
+      return write_result::written;
+}
+
+iscreate::artifact_cache::artifact_cache(const std::string &dir)
+    : dir(dir) {
+
+      std::ifstream in(dir, std::ios::binary);
+      if (!in.is_open()) {
+            return;
+      }
+
+      /* 16 hex digits, a space, then the output path */
+      std::string line = "";
+      while (std::getline(in, line)) {
+            if (line.size() < 18u || line[16] != ' ') {
+                  continue;
+            }
+            std::uint64_t hash = 0u;
+            auto valid = true;
+            for (auto idx = 0u; idx < 16u && valid; ++idx) {
+                  const auto c = line[idx];
+                  valid = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+                  hash = (hash << 4u) | static_cast<std::uint64_t>(c <= '9' ? c - '0' : c - 'a' + 10);
+            }
+            if (valid) {
+                  this->entries[line.substr(17u)] = hash;
+            }
+      }
+
+      return;
+}
+
+bool iscreate::artifact_cache::current(const std::string &output, const std::uint64_t hash) const {
+      const auto found = this->entries.find(output);
+      if (found == this->entries.end() || found->second != hash) {
+            return false;
+      }
+      return std::ifstream(output, std::ios::binary).is_open();
+}
+
+void iscreate::artifact_cache::save() {
+
+      /* Nothing */
+      if (!this->dirty) {
+            return;
+      }
+
+      std::string contents = "";
+      for (const auto &entry : this->entries) {
+            for (auto shift = 60; shift >= 0; shift -= 4) {
+                  contents += "0123456789abcdef"[(entry.second >> shift) & 0xFu];
+            }
+            contents.append(" ").append(entry.first).append("\n");
+      }
+
+      if (write_if_changed(this->dir, contents) != write_result::failed) {
+            this->dirty = false;
+      }
+
+      return;
+}
+
+bool iscreate::regenerate_save(instruction_set &set, const std::string &dir, artifact_cache &cache) {
+
+      /* Every instruction field ends up in the file */
+      const auto hash = fnv1a().add(std::string("save")).add(set.fingerprint(artifact::all)).value();
+      if (cache.current(dir, hash)) {
+            return false;
+      }
+
+      std::ostringstream out;
+      set.save(out);
+
+      const auto result = write_if_changed(dir, out.str());
+      if (result != write_result::failed) {
+            cache.update(dir, hash);
+      }
+
+      return result == write_result::written;
+}
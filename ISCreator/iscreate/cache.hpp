@@ -0,0 +1,185 @@
+#pragma once
+#include "iscreate.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace iscreate {
+
+      enum class write_result : std::uint8_t {
+            unchanged, /* File already held the bytes, left untouched. */
+            written,
+            failed
+      };
+
+      /* Write contents to dir only when the file does not already hold exactly those bytes. */
+      write_result write_if_changed(const std::string &dir, const std::string &contents);
+
+      /* Output file hashes kept on disk between runs, one "hash path" line per output. */
+      class artifact_cache {
+
+          public:
+            /* Load cache from dir, a missing file is an empty cache. */
+            artifact_cache(const std::string &dir);
+
+            /* See if output was last created from input with hash and is still on disk. */
+            bool current(const std::string &output, std::uint64_t hash) const;
+
+            void update(const std::string &output, std::uint64_t hash) {
+                  auto &entry = this->entries[output];
+                  this->dirty = this->dirty || entry != hash;
+                  entry = hash;
+                  return;
+            }
+
+            /* Write the cache back when anything changed. */
+            void save();
+
+            void clear() {
+                  this->dirty = this->dirty || !this->entries.empty();
+                  this->entries.clear();
+                  return;
+            }
+
+          private:
+            std::string dir = "";
+            std::map<std::string, std::uint64_t> entries;
+            bool dirty = false;
+      };
+
+      /* Output file for each artifact, artifacts with an empty path are not generated. */
+      struct artifact_files {
+            std::string enum_opcodes = "";
+            std::string enum_opencodings = "";
+            std::string enum_opkinds = "";
+            std::string opencodings = "";
+            std::string opkinds = "";
+            std::string opdescriptors = "";
+
+            /* Stand-alone generators, each output is its represent_* string. */
+            std::string decoder = "";
+            std::string bulk_decoder = "";
+            std::string mnemonic_lookup = "";
+            std::string packed_operands = "";
+            std::string encoder = "";
+            std::string formatter = "";
+            std::string dispatch = "";
+            std::string interpreter = "";
+            std::string block_cache = "";
+      };
+
+      /* Regenerate only artifacts whose input hash changed and rewrite only files whose bytes changed, returns the number of files written. */
+      template <language lang = language::cpp, table mode = table::map>
+      std::size_t regenerate(instruction_set &set, const artifact_files &files, artifact_cache &cache) {
+
+            const std::pair<std::uint8_t, const std::string artifact_files::*> outputs[] = {
+                {artifact::enum_opcodes, &artifact_files::enum_opcodes},
+                {artifact::enum_opencodings, &artifact_files::enum_opencodings},
+                {artifact::enum_opkinds, &artifact_files::enum_opkinds},
+                {artifact::opencodings, &artifact_files::opencodings},
+                {artifact::opkinds, &artifact_files::opkinds},
+                {artifact::opdescriptors, &artifact_files::opdescriptors}};
+
+            /* Select stale artifacts */
+            std::uint8_t which = 0u;
+            std::uint64_t hashes[6] = {};
+            for (auto idx = 0u; idx < 6u; ++idx) {
+                  const auto &dir = files.*outputs[idx].second;
+                  if (dir.empty()) {
+                        continue;
+                  }
+                  hashes[idx] = set.fingerprint<lang, mode>(outputs[idx].first);
+                  if (!cache.current(dir, hashes[idx])) {
+                        which |= outputs[idx].first;
+                  }
+            }
+
+            std::size_t written = 0u;
+            const auto store = [&](const std::string &dir, const std::string &contents, const std::uint64_t hash) {
+                  switch (write_if_changed(dir, contents)) {
+                        case write_result::written: {
+                              ++written;
+                              cache.update(dir, hash);
+                              break;
+                        }
+                        case write_result::unchanged: {
+                              cache.update(dir, hash);
+                              break;
+                        }
+                        default: {
+                              break;
+                        }
+                  }
+                  return;
+            };
+
+            /* Stand-alone generators read every instruction field and enum name, dispatch also reads the opcode maps. */
+            const struct {
+                  const char *name;
+                  const std::string artifact_files::*dir;
+                  std::string (*generate)(instruction_set &);
+            } generators[] = {
+                {"decoder", &artifact_files::decoder, [](instruction_set &s) { return s.represent_decoder<lang>(); }},
+                {"bulk_decoder", &artifact_files::bulk_decoder, [](instruction_set &s) { return s.represent_bulk_decoder<lang>(); }},
+                {"mnemonic_lookup", &artifact_files::mnemonic_lookup, [](instruction_set &s) { return s.represent_mnemonic_lookup<lang>(); }},
+                {"packed_operands", &artifact_files::packed_operands, [](instruction_set &s) { return s.represent_packed_operands<lang>(); }},
+                {"encoder", &artifact_files::encoder, [](instruction_set &s) { return s.represent_encoder<lang>(); }},
+                {"formatter", &artifact_files::formatter, [](instruction_set &s) { return s.represent_formatter<lang>(); }},
+                {"dispatch", &artifact_files::dispatch, [](instruction_set &s) { return s.represent_dispatch<lang>(); }},
+                {"interpreter", &artifact_files::interpreter, [](instruction_set &s) { return s.represent_interpreter<lang>(); }},
+                {"block_cache", &artifact_files::block_cache, [](instruction_set &s) { return s.represent_block_cache<lang>(); }}};
+            std::uint64_t everything = 0u;
+            auto hashed = false;
+            for (const auto &generator : generators) {
+                  const auto &dir = files.*generator.dir;
+                  if (dir.empty()) {
+                        continue;
+                  }
+                  if (!hashed) {
+                        everything = set.fingerprint<lang>(artifact::all);
+                        hashed = true;
+                  }
+                  fnv1a hash;
+                  hash.add(std::string(generator.name)).add(everything);
+                  if (generator.dir == &artifact_files::dispatch) {
+                        for (const auto &map : set.opcode_maps) {
+                              hash.add(static_cast<std::uint64_t>(map.size()));
+                              for (const auto byte : map) {
+                                    hash.add(static_cast<std::uint64_t>(byte));
+                              }
+                        }
+                  }
+                  if (cache.current(dir, hash.value())) {
+                        continue;
+                  }
+
+                  /* A generator that rejects the set reports why and writes nothing. */
+                  const auto code = generator.generate(set);
+                  if (!code.empty()) {
+                        store(dir, code, hash.value());
+                  }
+            }
+
+            /* Nothing */
+            if (which == 0u) {
+                  return written;
+            }
+
+            const auto code = set.represent<lang, mode>(which);
+            const std::string artifacts::*strings[] = {&artifacts::enum_opcodes, &artifacts::enum_opencodings, &artifacts::enum_opkinds, &artifacts::opencodings, &artifacts::opkinds, &artifacts::opdescriptors};
+
+            for (auto idx = 0u; idx < 6u; ++idx) {
+                  if ((which & outputs[idx].first) == 0u) {
+                        continue;
+                  }
+                  store(files.*outputs[idx].second, code.*strings[idx], hashes[idx]);
+            }
+
+            return written;
+      }
+
+      /* Save set to dir unless its content hash is unchanged or the file already holds the same bytes, returns true when written. */
+      bool regenerate_save(instruction_set &set, const std::string &dir, artifact_cache &cache);
+
+} // namespace iscreate
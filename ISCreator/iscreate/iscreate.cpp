@@ -1,144 +1,677 @@
 #include "iscreate.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
-#include <rapidjson/document.h>
-#include <rapidjson/stringbuffer.h>
+#include <rapidjson/error/en.h>
+#include <rapidjson/memorystream.h>
+#include <rapidjson/reader.h>
 #include <rapidjson/writer.h>
 
-void iscreate::instruction_set::save(const std::string &dir) {
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
-      rapidjson::Document doc;
-      doc.SetArray();
+namespace {
 
-      for (const auto &i : this->instructions) {
+      /* rapidjson output stream that writes to a stream in fixed size chunks. */
+      class buffered_ostream {
 
-            rapidjson::Value inst(rapidjson::kObjectType);
+          public:
+            typedef char Ch;
 
-            rapidjson::Value mnemonic(i.second.mnemonic.c_str(), doc.GetAllocator());
-            rapidjson::Value hint(i.second.hint.c_str(), doc.GetAllocator());
-            inst.AddMember("mnemonic", mnemonic, doc.GetAllocator());
-            inst.AddMember("hint", hint, doc.GetAllocator());
-            inst.AddMember("opcode", i.first, doc.GetAllocator());
+            buffered_ostream(std::ostream &out)
+                : out(out) {
+            }
 
-            rapidjson::Value operands(rapidjson::kArrayType);
-            for (const auto &operand : i.second.operands) {
+            ~buffered_ostream() {
+                  this->Flush();
+            }
+
+            void Put(Ch c) {
+                  if (this->used == sizeof(this->buffer)) {
+                        this->Flush();
+                  }
+                  this->buffer[this->used++] = c;
+                  return;
+            }
+
+            void Flush() {
+                  if (this->used != 0u) {
+                        this->out.write(this->buffer, static_cast<std::streamsize>(this->used));
+                        this->total += this->used;
+                        this->used = 0u;
+                  }
+                  return;
+            }
+
+            /* Bytes put so far */
+            std::size_t written() const {
+                  return this->total + this->used;
+            }
+
+          private:
+            std::ostream &out;
+            char buffer[64u * 1024u];
+            std::size_t used = 0u;
+            std::size_t total = 0u;
+      };
+
+      /* SAX handler that builds instructions straight from parser events, no document is kept. Instructions are collected in file order. */
+      class load_handler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, load_handler> {
+
+          public:
+            load_handler(std::vector<std::pair<std::intptr_t, iscreate::instruction>> &instructions, iscreate::instruction_set &set)
+                : instructions(instructions), set(set) {
+            }
+
+            bool StartArray() {
+                  if (this->skipping) {
+                        ++this->depth;
+                        return true;
+                  }
+                  if (this->where == place::top) {
+                        this->where = place::set;
+                        return true;
+                  }
+                  if (this->where == place::instruction && this->field == member::operands) {
+                        this->where = place::operands;
+                        this->seen |= member::operands;
+                        return true;
+                  }
+                  return this->Default();
+            }
+
+            bool EndArray(rapidjson::SizeType) {
+                  if (this->skipping) {
+                        this->skipping = --this->depth != 0u;
+                        return true;
+                  }
+                  this->where = this->where == place::operands ? place::instruction : place::done;
+                  return true;
+            }
+
+            bool StartObject() {
+                  if (this->skipping) {
+                        ++this->depth;
+                        return true;
+                  }
+                  if (this->where == place::set) {
+                        this->where = place::instruction;
+                        this->current = iscreate::instruction();
+                        this->seen = 0u;
+                        return true;
+                  }
+                  if (this->where == place::operands) {
+                        this->where = place::operand;
+                        this->op = iscreate::operand();
+                        this->op_seen = 0u;
+                        return true;
+                  }
+                  return this->Default();
+            }
+
+            bool EndObject(rapidjson::SizeType) {
+                  if (this->skipping) {
+                        this->skipping = --this->depth != 0u;
+                        return true;
+                  }
+                  if (this->where == place::operand) {
+                        {
+                              ISCREATE_PHASE(this->set.stats(iscreate::phase::validate), nullptr);
+                              if (!this->require(this->op_seen, member::operand_, "an string for operand") || !this->require(this->op_seen, member::encoding, "an string for encoding") || !this->require(this->op_seen, member::size, "an string for size") || !this->require(this->op_seen, member::hint, "an string for hint") || !this->require(this->op_seen, member::kind, "an string for kind")) {
+                                    return false;
+                              }
+                        }
+                        this->current.operands.emplace_back(std::move(this->op));
+                        this->where = place::operands;
+                        return true;
+                  }
+                  {
+                        ISCREATE_PHASE(this->set.stats(iscreate::phase::validate), nullptr);
+                        if (!this->require(this->seen, member::mnemonic, "an string for mnemonic") || !this->require(this->seen, member::hint, "an string for hint") || !this->require(this->seen, member::opcode, "an int for opcode") || !this->require(this->seen, member::operands, "an array for operands")) {
+                              return false;
+                        }
+                  }
+                  this->instructions.emplace_back(this->opcode, std::move(this->current));
+                  this->where = place::set;
+                  return true;
+            }
+
+            bool Key(const char *str, rapidjson::SizeType length, bool) {
+                  if (this->skipping) {
+                        return true;
+                  }
+                  const std::string key(str, length);
+                  this->field = member::none;
+                  if (this->where == place::instruction) {
+                        this->field = key == "mnemonic" ? member::mnemonic : key == "hint" ? member::hint : key == "opcode" ? member::opcode : key == "operands" ? member::operands : member::none;
+                  } else if (this->where == place::operand) {
+                        this->field = key == "operand" ? member::operand_ : key == "encoding" ? member::encoding : key == "size" ? member::size : key == "hint" ? member::hint : key == "kind" ? member::kind : member::none;
+                  }
+                  /* Unknown members are ignored like before. */
+                  if (this->field == member::none) {
+                        this->skipping = true;
+                        this->depth = 0u;
+                  }
+                  return true;
+            }
+
+            bool String(const char *str, rapidjson::SizeType length, bool) {
+                  if (this->skipping) {
+                        return this->leave();
+                  }
+                  std::string *target = nullptr;
+                  if (this->where == place::instruction) {
+                        target = this->field == member::mnemonic ? &this->current.mnemonic : this->field == member::hint ? &this->current.hint : nullptr;
+                        this->seen |= target != nullptr ? this->field : 0u;
+                  } else if (this->where == place::operand) {
+                        target = this->field == member::operand_ ? &this->op.operand_ : this->field == member::encoding ? &this->op.encoding : this->field == member::size ? &this->op.size : this->field == member::hint ? &this->op.hint : this->field == member::kind ? &this->op.kind : nullptr;
+                        this->op_seen |= target != nullptr ? this->field : 0u;
+                  }
+                  if (target == nullptr) {
+                        return this->Default();
+                  }
+                  target->assign(str, length);
+                  return true;
+            }
+
+            bool Int64(std::int64_t i) {
+                  if (this->skipping) {
+                        return this->leave();
+                  }
+                  if (this->where != place::instruction || this->field != member::opcode) {
+                        return this->Default();
+                  }
+                  this->opcode = static_cast<std::intptr_t>(i);
+                  this->seen |= member::opcode;
+                  return true;
+            }
 
-                  rapidjson::Value operandv(rapidjson::kObjectType);
+            bool Int(int i) {
+                  return this->Int64(i);
+            }
 
-                  rapidjson::Value operand_o(operand.operand_.c_str(), doc.GetAllocator());
-                  rapidjson::Value encoding_o(operand.encoding.c_str(), doc.GetAllocator());
-                  rapidjson::Value size_o(operand.size.c_str(), doc.GetAllocator());
-                  rapidjson::Value hint_o(operand.hint.c_str(), doc.GetAllocator());
-                  rapidjson::Value kind_o(operand.kind.c_str(), doc.GetAllocator());
+            bool Uint(unsigned i) {
+                  return this->Int64(i);
+            }
 
-                  operandv.AddMember("operand", operand_o, doc.GetAllocator());
-                  operandv.AddMember("encoding", encoding_o, doc.GetAllocator());
-                  operandv.AddMember("size", size_o, doc.GetAllocator());
-                  operandv.AddMember("hint", hint_o, doc.GetAllocator());
-                  operandv.AddMember("kind", kind_o, doc.GetAllocator());
+            bool Uint64(std::uint64_t i) {
+                  return i <= static_cast<std::uint64_t>(INT64_MAX) ? this->Int64(static_cast<std::int64_t>(i)) : this->Default();
+            }
 
-                  operands.PushBack(operandv, doc.GetAllocator());
+            /* Any value the schema does not expect */
+            bool Default() {
+                  if (this->skipping) {
+                        return this->leave();
+                  }
+                  switch (this->where) {
+                        case place::top: {
+                              this->error = "Invalid JSON format. Expected an array.";
+                              break;
+                        }
+                        case place::set: {
+                              this->error = "Invalid JSON format. Expected an object for instruction.";
+                              break;
+                        }
+                        case place::operands: {
+                              this->error = "Invalid JSON format. Expected an object for operand.";
+                              break;
+                        }
+                        case place::instruction: {
+                              this->error = std::string("Invalid JSON format. Expected ") + (this->field == member::opcode ? "an int for opcode." : this->field == member::operands ? "an array for operands." : this->field == member::mnemonic ? "an string for mnemonic." : "an string for hint.");
+                              break;
+                        }
+                        case place::operand: {
+                              this->error = std::string("Invalid JSON format. Expected an string for ") + (this->field == member::operand_ ? "operand." : this->field == member::encoding ? "encoding." : this->field == member::size ? "size." : this->field == member::hint ? "hint." : "kind.");
+                              break;
+                        }
+                        default: {
+                              this->error = "Invalid JSON format.";
+                              break;
+                        }
+                  }
+                  return false;
             }
 
-            inst.AddMember("operands", operands, doc.GetAllocator());
-            doc.PushBack(inst, doc.GetAllocator());
+            std::string error = "";
+
+          private:
+            enum class place : std::uint8_t {
+                  top,
+                  set,
+                  instruction,
+                  operands,
+                  operand,
+                  done
+            };
+
+            /* Member bits, instruction and operand members share hint. */
+            struct member {
+                  static constexpr std::uint32_t none = 0u;
+                  static constexpr std::uint32_t mnemonic = 1u << 0u;
+                  static constexpr std::uint32_t hint = 1u << 1u;
+                  static constexpr std::uint32_t opcode = 1u << 2u;
+                  static constexpr std::uint32_t operands = 1u << 3u;
+                  static constexpr std::uint32_t operand_ = 1u << 4u;
+                  static constexpr std::uint32_t encoding = 1u << 5u;
+                  static constexpr std::uint32_t size = 1u << 6u;
+                  static constexpr std::uint32_t kind = 1u << 7u;
+            };
+
+            /* Scalar inside a skipped member, a bare scalar ends the skip. */
+            bool leave() {
+                  this->skipping = this->depth != 0u;
+                  return true;
+            }
+
+            bool require(std::uint32_t seen, std::uint32_t bit, const char *expected) {
+                  if (!(seen & bit)) {
+                        this->error = std::string("Invalid JSON format. Expected ") + expected + ".";
+                        return false;
+                  }
+                  return true;
+            }
+
+            std::vector<std::pair<std::intptr_t, iscreate::instruction>> &instructions;
+            iscreate::instruction_set &set; /* Only records validation time */
+            iscreate::instruction current;
+            iscreate::operand op;
+            std::intptr_t opcode = 0;
+            place where = place::top;
+            std::uint32_t field = member::none;
+            std::uint32_t seen = 0u;
+            std::uint32_t op_seen = 0u;
+            bool skipping = false;
+            std::size_t depth = 0u;
+      };
+
+} // namespace
+
+iscreate::mapped_file::mapped_file(const std::string &dir) {
+
+#if defined(_WIN32)
+      const auto file = CreateFileA(dir.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+      if (file == INVALID_HANDLE_VALUE) {
+            return;
+      }
+      this->handle = file;
+
+      LARGE_INTEGER size;
+      if (!GetFileSizeEx(file, &size)) {
+            return;
+      }
+      this->open = true;
+      if (size.QuadPart == 0) {
+            return;
+      }
+
+      this->mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (this->mapping == nullptr) {
+            this->open = false;
+            return;
+      }
+      this->view = static_cast<const char *>(MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0));
+      this->length = this->view != nullptr ? static_cast<std::size_t>(size.QuadPart) : 0u;
+      this->open = this->view != nullptr;
+#else
+      const auto file = ::open(dir.c_str(), O_RDONLY);
+      if (file < 0) {
+            return;
       }
 
-      rapidjson::StringBuffer buffer;
-      rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-      doc.Accept(writer);
+      struct stat info;
+      if (fstat(file, &info) != 0) {
+            close(file);
+            return;
+      }
+      this->open = true;
+      if (info.st_size == 0) {
+            close(file);
+            return;
+      }
+
+      const auto view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+      close(file);
+      if (view == MAP_FAILED) {
+            this->open = false;
+            return;
+      }
+      madvise(view, static_cast<std::size_t>(info.st_size), MADV_SEQUENTIAL);
+      this->view = static_cast<const char *>(view);
+      this->length = static_cast<std::size_t>(info.st_size);
+#endif
+
+      return;
+}
+
+iscreate::mapped_file::~mapped_file() {
+
+#if defined(_WIN32)
+      if (this->view != nullptr) {
+            UnmapViewOfFile(this->view);
+      }
+      if (this->mapping != nullptr) {
+            CloseHandle(this->mapping);
+      }
+      if (this->handle != nullptr) {
+            CloseHandle(this->handle);
+      }
+#else
+      if (this->view != nullptr) {
+            munmap(const_cast<char *>(this->view), this->length);
+      }
+#endif
+
+      return;
+}
+
+iscreate::sink iscreate::create_sink(const int descriptor, const std::size_t chunk) {
+
+      /* Loop until the whole chunk is out, writes can be partial. */
+      const auto write = [descriptor](const char *data, std::size_t size) {
+            while (size != 0u) {
+#if defined(_WIN32)
+                  const auto done = _write(descriptor, data, static_cast<unsigned int>(std::min<std::size_t>(size, 0x40000000u)));
+#else
+                  const auto done = ::write(descriptor, data, size);
+                  if (done < 0 && errno == EINTR) {
+                        continue;
+                  }
+#endif
+                  if (done <= 0) {
+                        std::cerr << "Failed to write to descriptor " + std::to_string(descriptor) + "." << std::endl;
+                        return;
+                  }
+                  data += done;
+                  size -= static_cast<std::size_t>(done);
+            }
+            return;
+      };
+
+      return sink(write, chunk);
+}
+
+void iscreate::instruction_set::save(const std::string &dir) {
 
       std::ofstream out(dir);
       if (!out.is_open()) {
             std::cerr << "Failed to open " + dir + "." << std::endl;
             return;
       }
-      out << buffer.GetString() << std::endl;
+
+      this->save(out);
+      if (!out) {
+            std::cerr << "Failed to write " + dir + "." << std::endl;
+      }
       out.close();
 
       return;
 }
 
-void iscreate::instruction_set::load(const std::string &dir) {
+void iscreate::instruction_set::save(std::ostream &out) {
+
+      /* Stream straight to out, nothing is held besides the write buffer. */
+      ISCREATE_PHASE(this->statistics[phase::write], nullptr);
+      buffered_ostream stream(out);
+      rapidjson::Writer<buffered_ostream> writer(stream);
+      const auto string = [&](const symbol id) {
+            const auto &str = this->str(id);
+            writer.String(str.c_str(), static_cast<rapidjson::SizeType>(str.size()));
+      };
+
+      writer.StartArray();
+      for (const auto &i : this->instructions) {
+
+            writer.StartObject();
+            writer.Key("mnemonic");
+            string(i.second.mnemonic);
+            writer.Key("hint");
+            string(i.second.hint);
+            writer.Key("opcode");
+            writer.Int64(i.first);
+
+            writer.Key("operands");
+            writer.StartArray();
+            for (const auto &operand : i.second.operands) {
+
+                  writer.StartObject();
+                  writer.Key("operand");
+                  string(operand.operand_);
+                  writer.Key("encoding");
+                  string(operand.encoding);
+                  writer.Key("size");
+                  string(operand.size);
+                  writer.Key("hint");
+                  string(operand.hint);
+                  writer.Key("kind");
+                  string(operand.kind);
+                  writer.EndObject();
+            }
+            writer.EndArray();
+
+            writer.EndObject();
+      }
+      writer.EndArray();
+
+      stream.Put('\n');
+      stream.Flush();
+      ISCREATE_BYTES(this->statistics[phase::write], stream.written());
+
+      return;
+}
+
+bool iscreate::instruction_set::try_load(const std::string &dir) {
 
-      std::ifstream in(dir);
-      if (!in.is_open()) {
+      const mapped_file file = [&]() {
+            ISCREATE_PHASE(this->statistics[phase::read], nullptr);
+            return mapped_file(dir);
+      }();
+      if (!file.is_open()) {
             std::cerr << "Failed to open " + dir + "." << std::endl;
+            return false;
+      }
+      ISCREATE_BYTES(this->statistics[phase::read], file.size());
+
+      /* Parse straight from the mapping, instructions are built from parser events without a document. */
+      std::vector<std::pair<std::intptr_t, instruction>> parsed;
+      load_handler handler(parsed, *this);
+      rapidjson::MemoryStream stream(file.data(), file.size());
+      rapidjson::Reader reader;
+      {
+            ISCREATE_PHASE(this->statistics[phase::parse], nullptr);
+            reader.Parse(stream, handler);
+      }
+
+      /* A file that stops partway adds nothing, like a document that fails to parse. */
+      if (!handler.error.empty()) {
+            std::cerr << handler.error << std::endl;
+            return false;
+      }
+      if (reader.HasParseError()) {
+            std::cerr << "Invalid JSON format at offset " << reader.GetErrorOffset() << ". " << rapidjson::GetParseError_En(reader.GetParseErrorCode()) << std::endl;
+            return false;
+      }
+
+      this->add_bulk(std::move(parsed));
+
+      return true;
+}
+
+void iscreate::instruction_set::save_binary(const std::string &dir) {
+
+      ISCREATE_PHASE(this->statistics[phase::write], nullptr);
+
+      std::vector<binary::instruction_record> records;
+      std::vector<binary::operand_record> operands;
+      std::vector<binary::string_ref> refs;
+      std::string strings = "";
+
+      records.reserve(this->instructions.size());
+
+      /* The symbol pool is already deduplicated, it becomes the string table as is. */
+      refs.reserve(this->symbols.size());
+      for (auto id = 0u; id < this->symbols.size(); ++id) {
+            const auto &str = this->symbols.str(id);
+            refs.push_back({static_cast<std::uint32_t>(strings.size()), static_cast<std::uint32_t>(str.size())});
+            strings += str;
+      }
+      const auto intern = [&](const symbol id) {
+            return refs[id];
+      };
+
+      for (const auto &i : this->instructions) {
+
+            binary::instruction_record record = {};
+            record.opcode = static_cast<std::int64_t>(i.first);
+            record.mnemonic = intern(i.second.mnemonic);
+            record.hint = intern(i.second.hint);
+            record.first_operand = static_cast<std::uint32_t>(operands.size());
+            record.num_operands = static_cast<std::uint32_t>(i.second.operands.size());
+            records.emplace_back(record);
+
+            for (const auto &operand : i.second.operands) {
+                  operands.push_back({intern(operand.operand_), intern(operand.encoding), intern(operand.size), intern(operand.hint), intern(operand.kind)});
+            }
+      }
+
+      if (strings.size() > UINT32_MAX) {
+            std::cerr << "Failed to save " + dir + ", string table exceeds 4 GiB." << std::endl;
             return;
       }
 
-      std::string json = "";
-      std::string line = "";
-      while (std::getline(in, line)) {
-            json += line;
+      binary::header header = {};
+      std::memcpy(header.magic, binary::magic, sizeof(header.magic));
+      header.version = binary::version;
+      header.endian = binary::endian;
+      header.instructions = records.size();
+      header.operands_offset = sizeof(binary::header) + records.size() * sizeof(binary::instruction_record);
+      header.operands = operands.size();
+      header.strings_offset = header.operands_offset + operands.size() * sizeof(binary::operand_record);
+      header.strings_size = strings.size();
+
+      std::ofstream out(dir, std::ios::binary);
+      if (!out.is_open()) {
+            std::cerr << "Failed to open " + dir + "." << std::endl;
+            return;
       }
-      in.close();
+      out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+      out.write(reinterpret_cast<const char *>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(binary::instruction_record)));
+      out.write(reinterpret_cast<const char *>(operands.data()), static_cast<std::streamsize>(operands.size() * sizeof(binary::operand_record)));
+      out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+      if (!out) {
+            std::cerr << "Failed to write " + dir + "." << std::endl;
+      }
+      ISCREATE_BYTES(this->statistics[phase::write], header.strings_offset + header.strings_size);
+      out.close();
+
+      return;
+}
 
-      rapidjson::Document document;
-      document.Parse(json.c_str());
-      if (!document.IsArray()) {
-            std::cerr << "Invalid JSON format. Expected an array." << std::endl;
+void iscreate::instruction_set::load_binary(const std::string &dir) {
+
+      const auto set = [&]() {
+            ISCREATE_PHASE(this->statistics[phase::read], nullptr);
+            return compiled_set(dir);
+      }();
+      if (!set.is_open()) {
+            std::cerr << "Failed to open " + dir + " as compiled instruction set." << std::endl;
             return;
       }
 
-      for (auto i = 0u; i < document.Size(); ++i) {
+      for (auto i = 0u; i < set.size(); ++i) {
 
-            const auto &inst = document[i];
+            const auto inst = set.at(i);
 
-            if (!inst.HasMember("mnemonic") || !inst["mnemonic"].IsString()) {
-                  std::cerr << "Invalid JSON format. Expected an string for mnemonic." << std::endl;
-                  return;
-            }
-            if (!inst.HasMember("hint") || !inst["hint"].IsString()) {
-                  std::cerr << "Invalid JSON format. Expected an string for hint." << std::endl;
-                  return;
-            }
-            if (!inst.HasMember("opcode") || !inst["opcode"].IsInt64()) {
-                  std::cerr << "Invalid JSON format. Expected an int for opcode." << std::endl;
-                  return;
+            std::vector<operand> operands;
+            operands.reserve(inst.size());
+            for (auto j = 0u; j < inst.size(); ++j) {
+                  const auto op = inst.at(j);
+                  operands.emplace_back(create_operand(std::string(op.operand_()), std::string(op.encoding()), std::string(op.size()), std::string(op.hint()), std::string(op.kind())));
             }
 
-            const auto mnemonic = inst["mnemonic"].GetString();
-            const auto hint = inst["hint"].GetString();
-            const auto opcode = inst["opcode"].GetInt64();
+            this->add(inst.opcode(), std::string(inst.mnemonic()), std::string(inst.hint()), std::move(operands));
+      }
 
-            if (!inst.HasMember("operands") || !inst["operands"].IsArray()) {
-                  std::cerr << "Invalid JSON format. Expected an array for operands." << std::endl;
-                  return;
-            }
+      return;
+}
 
-            std::vector<operand> operands;
+iscreate::compiled_set::compiled_set(const std::string &dir)
+    : file(dir) {
 
-            const auto &operand = inst["operands"];
-            for (auto j = 0u; j < operand.Size(); ++j) {
-                  const auto &operandf = operand[j];
+      const auto data = this->file.data();
+      const auto size = static_cast<std::uint64_t>(this->file.size());
+      if (data == nullptr || size < sizeof(binary::header)) {
+            return;
+      }
 
-                  if (!operandf.HasMember("operand") || !operandf["operand"].IsString()) {
-                        std::cerr << "Invalid JSON format. Expected an string for operand." << std::endl;
-                        return;
-                  }
-                  if (!operandf.HasMember("encoding") || !operandf["encoding"].IsString()) {
-                        std::cerr << "Invalid JSON format. Expected an string for encoding." << std::endl;
-                        return;
-                  }
-                  if (!operandf.HasMember("size") || !operandf["size"].IsString()) {
-                        std::cerr << "Invalid JSON format. Expected an string for size." << std::endl;
-                        return;
-                  }
-                  if (!operandf.HasMember("hint") || !operandf["hint"].IsString()) {
-                        std::cerr << "Invalid JSON format. Expected an string for hint." << std::endl;
-                        return;
-                  }
-                  if (!operandf.HasMember("kind") || !operandf["kind"].IsString()) {
-                        std::cerr << "Invalid JSON format. Expected an string for kind." << std::endl;
-                        return;
-                  }
+      /* Header */
+      const auto header = reinterpret_cast<const binary::header *>(data);
+      if (std::memcmp(header->magic, binary::magic, sizeof(header->magic)) != 0 || header->version != binary::version || header->endian != binary::endian) {
+            return;
+      }
+      if (header->instructions > (size - sizeof(binary::header)) / sizeof(binary::instruction_record) ||
+          header->operands_offset != sizeof(binary::header) + header->instructions * sizeof(binary::instruction_record) ||
+          header->operands > (size - header->operands_offset) / sizeof(binary::operand_record) ||
+          header->strings_offset != header->operands_offset + header->operands * sizeof(binary::operand_record) ||
+          header->strings_size > size - header->strings_offset) {
+            return;
+      }
 
-                  operands.emplace_back(create_operand(operandf["operand"].GetString(), operandf["encoding"].GetString(), operandf["size"].GetString(), operandf["hint"].GetString(), operandf["kind"].GetString()));
-            }
+      this->count = static_cast<std::size_t>(header->instructions);
+      this->instructions = reinterpret_cast<const binary::instruction_record *>(data + sizeof(binary::header));
+      this->operands = reinterpret_cast<const binary::operand_record *>(data + header->operands_offset);
+      this->strings = data + header->strings_offset;
 
-            this->add(opcode, mnemonic, hint, operands);
+      /* Every reference must stay inside the file, records are not parsed beyond this. */
+      const auto inside = [&](const binary::string_ref &ref) {
+            return static_cast<std::uint64_t>(ref.offset) + ref.length <= header->strings_size;
+      };
+      for (auto i = 0u; i < this->count; ++i) {
+            const auto &record = this->instructions[i];
+            if (!inside(record.mnemonic) || !inside(record.hint) || static_cast<std::uint64_t>(record.first_operand) + record.num_operands > header->operands || (i != 0u && this->instructions[i - 1u].opcode >= record.opcode)) {
+                  return;
+            }
+      }
+      for (auto i = 0u; i < header->operands; ++i) {
+            const auto &record = this->operands[i];
+            if (!inside(record.operand_) || !inside(record.encoding) || !inside(record.size) || !inside(record.hint) || !inside(record.kind)) {
+                  return;
+            }
       }
 
+      this->valid = true;
+      return;
+}
+
+#if defined(ISCREATE_STATS)
+namespace {
+
+      std::atomic<iscreate::allocation_counter> counter{nullptr};
+
+} // namespace
+
+void iscreate::set_allocation_counter(const allocation_counter count) {
+      counter.store(count, std::memory_order_release);
       return;
 }
+
+std::uint64_t iscreate::allocation_count() {
+      const auto count = counter.load(std::memory_order_acquire);
+      return count != nullptr ? count() : 0u;
+}
+#endif
@@ -1,8 +1,21 @@
 #pragma once
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <iterator>
 #include <map>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace iscreate {
@@ -12,6 +25,130 @@ namespace iscreate {
             c
       };
 
+      enum class table : std::uint8_t {
+            map, /* Keyed by opcode, works for any opcode layout. */
+            flat /* Constant array indexed by opcode, needs contiguous opcodes. */
+      };
+
+      /* Artifact selection bits for instruction_set::represent */
+      struct artifact {
+            static constexpr std::uint8_t enum_opcodes = 1u << 0u;
+            static constexpr std::uint8_t enum_opencodings = 1u << 1u;
+            static constexpr std::uint8_t enum_opkinds = 1u << 2u;
+            static constexpr std::uint8_t opencodings = 1u << 3u;
+            static constexpr std::uint8_t opkinds = 1u << 4u;
+            static constexpr std::uint8_t opdescriptors = 1u << 5u;
+            static constexpr std::uint8_t all = 0x3Fu;
+      };
+
+      /* Generated code for each artifact, unselected ones stay empty. */
+      struct artifacts {
+            std::string enum_opcodes = "";
+            std::string enum_opencodings = "";
+            std::string enum_opkinds = "";
+            std::string opencodings = "";
+            std::string opkinds = "";
+            std::string opdescriptors = "";
+      };
+
+      /* Buffered destination for generated code, full chunks are handed to the target as they fill. */
+      class sink {
+
+          public:
+            typedef std::function<void(const char *data, std::size_t size)> callback;
+
+            static constexpr std::size_t default_chunk = 64u * 1024u;
+
+            sink(callback target, const std::size_t chunk = default_chunk)
+                : target(std::move(target)), chunk(chunk != 0u ? chunk : 1u) {
+                  this->buffer.reserve(this->chunk);
+            }
+
+            sink(const sink &) = delete;
+            sink &operator=(const sink &) = delete;
+            sink &operator=(sink &&) = delete;
+
+            sink(sink &&other)
+                : target(std::move(other.target)), buffer(std::move(other.buffer)), chunk(other.chunk), total(other.total) {
+                  other.buffer.clear();
+            }
+
+            ~sink() {
+                  this->flush();
+            }
+
+            sink &append(const char *data, const std::size_t size) {
+                  if (this->buffer.size() + size > this->chunk) {
+                        this->flush();
+                        /* Too big to buffer, pass it straight through. */
+                        if (size >= this->chunk) {
+                              this->target(data, size);
+                              this->total += size;
+                              return *this;
+                        }
+                  }
+                  this->buffer.append(data, size);
+                  return *this;
+            }
+
+            sink &append(const char *str) {
+                  return this->append(str, std::char_traits<char>::length(str));
+            }
+
+            sink &append(const std::string &str) {
+                  return this->append(str.data(), str.size());
+            }
+
+            /* Hand everything buffered to the target */
+            void flush() {
+                  if (!this->buffer.empty()) {
+                        this->target(this->buffer.data(), this->buffer.size());
+                        this->total += this->buffer.size();
+                        this->buffer.clear();
+                  }
+                  return;
+            }
+
+            /* Bytes appended so far, flushed or not */
+            std::size_t written() const {
+                  return this->total + this->buffer.size();
+            }
+
+          private:
+            callback target;
+            std::string buffer;
+            std::size_t chunk = default_chunk;
+            std::size_t total = 0u;
+      };
+
+      /* Where instruction_set::represent writes each artifact, null entries are skipped. */
+      struct artifact_sinks {
+            sink *enum_opcodes = nullptr;
+            sink *enum_opencodings = nullptr;
+            sink *enum_opkinds = nullptr;
+            sink *opencodings = nullptr;
+            sink *opkinds = nullptr;
+            sink *opdescriptors = nullptr;
+      };
+
+      /* Sink that calls target with each chunk */
+      __inline sink create_sink(sink::callback target, const std::size_t chunk = sink::default_chunk) {
+            return sink(std::move(target), chunk);
+      }
+
+      /* Sink that writes to a stream */
+      __inline sink create_sink(std::ostream &out, const std::size_t chunk = sink::default_chunk) {
+            return sink([&out](const char *data, const std::size_t size) { out.write(data, static_cast<std::streamsize>(size)); }, chunk);
+      }
+
+      /* Sink that appends to a string */
+      __inline sink create_sink(std::string &out, const std::size_t chunk = sink::default_chunk) {
+            return sink([&out](const char *data, const std::size_t size) { out.append(data, size); }, chunk);
+      }
+
+      /* Sink that writes to an open file descriptor */
+      sink create_sink(int descriptor, std::size_t chunk = sink::default_chunk);
+
       struct operand {
             std::string operand_ = "";
             std::string encoding = "";
@@ -26,206 +163,2378 @@ namespace iscreate {
             std::vector<operand> operands;
       };
 
-      class instruction_set {
+      /* Interned string id */
+      typedef std::uint32_t symbol;
+
+      /* Stores every distinct string once, ids are handed out in first seen order. */
+      class symbol_pool {
 
           public:
-            instruction_set(const std::string &name)
-                : name(name) {
+            static constexpr symbol npos = 0xFFFFFFFFu;
+
+            symbol_pool() = default;
+
+            /* Index keys view into the strings, a copy has to point them at its own. */
+            symbol_pool(const symbol_pool &other)
+                : strings(other.strings) {
+                  this->rebuild();
             }
 
-#pragma region add
+            symbol_pool &operator=(const symbol_pool &other) {
+                  if (this != &other) {
+                        this->strings = other.strings;
+                        this->rebuild();
+                  }
+                  return *this;
+            }
 
-            /* Add instruction */
-            template <std::intptr_t opcode>
-            void add(const std::string &mnemonic, const std::string &hint) {
-                  instruction i;
-                  i.mnemonic = mnemonic;
-                  i.hint = hint;
-                  this->instructions.insert(std::make_pair(opcode, i));
+            /* Moving the deque keeps its strings where they are, the keys stay valid. */
+            symbol_pool(symbol_pool &&) = default;
+            symbol_pool &operator=(symbol_pool &&) = default;
+
+            /* Id of string, added when new. */
+            symbol intern(std::string_view str) {
+                  const auto found = this->index.find(str);
+                  if (found != this->index.end()) {
+                        return found->second;
+                  }
+                  const auto id = static_cast<symbol>(this->strings.size());
+                  this->strings.emplace_back(str);
+                  this->index.emplace(this->strings.back(), id);
+                  return id;
+            }
+
+            /* Id of string, moved into the pool when new. */
+            symbol intern(std::string &&str) {
+                  const auto found = this->index.find(str);
+                  if (found != this->index.end()) {
+                        return found->second;
+                  }
+                  const auto id = static_cast<symbol>(this->strings.size());
+                  this->strings.emplace_back(std::move(str));
+                  this->index.emplace(this->strings.back(), id);
+                  return id;
+            }
+
+            const std::string &str(symbol id) const {
+                  return this->strings[id];
+            }
+
+            /* Id of string, npos when it was never interned. */
+            symbol find(std::string_view str) const {
+                  const auto found = this->index.find(str);
+                  return found != this->index.end() ? found->second : npos;
+            }
+
+            std::size_t size() const {
+                  return this->strings.size();
+            }
+
+            /* Estimated heap bytes of the strings and their index */
+            std::size_t memory_usage() const {
+                  const auto inline_capacity = std::string().capacity();
+                  std::size_t retn = this->strings.size() * sizeof(std::string);
+                  for (const auto &str : this->strings) {
+                        retn += str.capacity() > inline_capacity ? str.capacity() + 1u : 0u;
+                  }
+                  retn += this->index.bucket_count() * sizeof(void *);
+                  retn += this->index.size() * (sizeof(std::pair<const std::string_view, symbol>) + 2u * sizeof(void *));
+                  return retn;
+            }
+
+            void clear() {
+                  this->index.clear();
+                  this->strings.clear();
                   return;
             }
 
-            /* Add instruction */
-            void add(const std::intptr_t opcode, const std::string &mnemonic, const std::string &hint, const std::vector<operand> &operands) {
-                  instruction i;
-                  i.mnemonic = mnemonic;
-                  i.hint = hint;
-                  i.operands = operands;
-                  this->instructions.insert(std::make_pair(opcode, i));
+          private:
+            void rebuild() {
+                  this->index.clear();
+                  this->index.reserve(this->strings.size());
+                  for (std::size_t id = 0u; id < this->strings.size(); ++id) {
+                        this->index.emplace(this->strings[id], static_cast<symbol>(id));
+                  }
                   return;
             }
 
-            /* Add instruction */
-            template <std::intptr_t opcode>
-            void add(const std::string &mnemonic, const std::string &hint, const std::vector<operand> &operands) {
-                  instruction i;
-                  i.mnemonic = mnemonic;
-                  i.hint = hint;
-                  i.operands = operands;
-                  this->instructions.insert(std::make_pair(opcode, i));
+            std::deque<std::string> strings; /* Stable addresses, index keys view into these. */
+            std::unordered_map<std::string_view, symbol> index;
+      };
+
+      struct interned_operand {
+            symbol operand_ = 0u;
+            symbol encoding = 0u;
+            symbol size = 0u;
+            symbol hint = 0u;
+            symbol kind = 0u;
+            std::uint32_t bits = 0u; /* Width parsed from size, 0 when it has no number. */
+      };
+
+      /* Operands of a stored instruction, a view into the pooled operand array. */
+      class operand_span {
+
+          public:
+            operand_span(const interned_operand *data, std::size_t count)
+                : data(data), count(count) {
+            }
+
+            const interned_operand *begin() const {
+                  return this->data;
+            }
+
+            const interned_operand *end() const {
+                  return this->data + this->count;
+            }
+
+            const interned_operand &operator[](std::size_t idx) const {
+                  return this->data[idx];
+            }
+
+            std::size_t size() const {
+                  return this->count;
+            }
+
+            bool empty() const {
+                  return this->count == 0u;
+            }
+
+          private:
+            const interned_operand *data;
+            std::size_t count;
+      };
+
+      struct stored_instruction {
+            symbol mnemonic;
+            symbol hint;
+            operand_span operands;
+      };
+
+      /* Opcode and instruction pair, shaped like a std::map entry. */
+      struct stored_entry {
+            std::intptr_t first;
+            stored_instruction second;
+      };
+
+      /* State rebuilt lazily behind const members. The first reader after invalidate() rebuilds while racing readers wait for it,
+         later readers pay one atomic load. Copies start stale. */
+      class refresh_guard {
+
+          public:
+            refresh_guard() = default;
+
+            refresh_guard(const refresh_guard &) {
+            }
+
+            refresh_guard &operator=(const refresh_guard &) {
+                  this->invalidate();
+                  return *this;
+            }
+
+            /* Writers only, the next refresh rebuilds. */
+            void invalidate() {
+                  this->fresh.store(false, std::memory_order_relaxed);
                   return;
             }
 
-            /* Add instruction */
-            void add(const std::string &mnemonic, const std::string &hint, const std::vector<operand> &operands) {
-                  instruction i;
-                  i.mnemonic = mnemonic;
-                  i.hint = hint;
-                  i.operands = operands;
-                  this->instructions.insert(std::make_pair(!this->instructions.empty() ? this->instructions.rbegin()->first + 1u : 0u, i));
+            /* Writers only */
+            bool stale() const {
+                  return !this->fresh.load(std::memory_order_relaxed);
+            }
+
+            template <typename callable>
+            void refresh(const callable &rebuild) const {
+                  if (this->fresh.load(std::memory_order_acquire)) {
+                        return;
+                  }
+                  const std::lock_guard<std::mutex> guard(this->lock);
+                  if (!this->fresh.load(std::memory_order_relaxed)) {
+                        rebuild();
+                        this->fresh.store(true, std::memory_order_release);
+                  }
                   return;
             }
 
-            /* Add instruction */
-            void add(const std::string &mnemonic, const std::string &hint) {
-                  instruction i;
-                  i.mnemonic = mnemonic;
-                  i.hint = hint;
-                  this->instructions.insert(std::make_pair(!this->instructions.empty() ? this->instructions.rbegin()->first + 1u : 0u, i));
+          private:
+            mutable std::mutex lock;
+            mutable std::atomic<bool> fresh{false};
+      };
+
+      /* Sorted opcode vector with parallel records and one pooled operand array, indexed directly while opcodes are contiguous.
+         Opcodes above every other one are appended in place, the rest wait at the end until the next read merges them in once. */
+      class instruction_store {
+
+          public:
+            static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+            instruction_store() = default;
+
+            /* Copies merge other first so they never read a merge in progress. */
+            instruction_store(const instruction_store &other) {
+                  *this = other;
+            }
+
+            instruction_store(instruction_store &&other) noexcept {
+                  *this = std::move(other);
+            }
+
+            instruction_store &operator=(const instruction_store &other) {
+                  if (this != &other) {
+                        other.settle();
+                        this->opcodes = other.opcodes;
+                        this->records = other.records;
+                        this->operands = other.operands;
+                        this->pending.clear();
+                        this->ordered = other.ordered;
+                        this->dense = other.dense;
+                        this->merged.invalidate();
+                  }
+                  return *this;
+            }
+
+            instruction_store &operator=(instruction_store &&other) noexcept {
+                  if (this != &other) {
+                        this->opcodes = std::move(other.opcodes);
+                        this->records = std::move(other.records);
+                        this->operands = std::move(other.operands);
+                        this->pending = std::move(other.pending);
+                        this->ordered = other.ordered;
+                        this->dense = other.dense;
+                        this->merged.invalidate();
+                        other.clear();
+                  }
+                  return *this;
+            }
+
+            class const_iterator {
+
+                public:
+                  /* Entries are built on access, -> needs somewhere to keep one. */
+                  struct arrow {
+                        stored_entry entry;
+                        const stored_entry *operator->() const {
+                              return &this->entry;
+                        }
+                  };
+
+                  const_iterator(const instruction_store *store, std::size_t idx)
+                      : store(store), idx(idx) {
+                  }
+
+                  stored_entry operator*() const {
+                        return this->store->at(this->idx);
+                  }
+
+                  arrow operator->() const {
+                        return arrow{this->store->at(this->idx)};
+                  }
+
+                  const_iterator &operator++() {
+                        ++this->idx;
+                        return *this;
+                  }
+
+                  bool operator==(const const_iterator &other) const {
+                        return this->idx == other.idx;
+                  }
+
+                  bool operator!=(const const_iterator &other) const {
+                        return this->idx != other.idx;
+                  }
+
+                private:
+                  const instruction_store *store;
+                  std::size_t idx;
+            };
+
+            /* Insert keeping opcode order, an existing opcode is kept like std::map::insert. Out of order opcodes are merged on the next read. */
+            bool insert(const std::intptr_t opcode, const symbol mnemonic, const symbol hint, const std::vector<interned_operand> &operands) {
+                  if (this->contains(opcode)) {
+                        return false;
+                  }
+                  const auto in_order = this->ordered == this->opcodes.size() && (this->opcodes.empty() || opcode > this->opcodes.back());
+                  const record r = {mnemonic, hint, static_cast<std::uint32_t>(this->operands.size()), static_cast<std::uint32_t>(operands.size())};
+                  this->operands.insert(this->operands.end(), operands.begin(), operands.end());
+                  this->opcodes.push_back(opcode);
+                  this->records.push_back(r);
+                  if (in_order) {
+                        this->ordered = this->opcodes.size();
+                        this->dense = this->span();
+                  } else {
+                        this->pending.insert(opcode);
+                        this->merged.invalidate();
+                  }
+                  return true;
+            }
+
+            /* See if opcode was inserted, unmerged inserts included. Not const as it reads them without merging, only writers call it. */
+            bool contains(const std::intptr_t opcode) {
+                  const auto end = this->opcodes.begin() + static_cast<std::ptrdiff_t>(this->ordered);
+                  const auto it = std::lower_bound(this->opcodes.begin(), end, opcode);
+                  return (it != end && *it == opcode) || (!this->pending.empty() && this->pending.count(opcode) != 0u);
+            }
+
+            /* Every insert so far was in opcode order. Writers only, a read may merge in between. */
+            bool ordered_inserts() const {
+                  return this->ordered == this->opcodes.size();
+            }
+
+            /* Position of opcode, npos when missing. */
+            std::size_t find(const std::intptr_t opcode) const {
+                  this->settle();
+                  if (this->opcodes.empty() || opcode < this->opcodes.front() || opcode > this->opcodes.back()) {
+                        return npos;
+                  }
+                  if (this->dense) {
+                        return static_cast<std::size_t>(static_cast<std::uintptr_t>(opcode) - static_cast<std::uintptr_t>(this->opcodes.front()));
+                  }
+                  const auto it = std::lower_bound(this->opcodes.begin(), this->opcodes.end(), opcode);
+                  return *it == opcode ? static_cast<std::size_t>(it - this->opcodes.begin()) : npos;
+            }
+
+            stored_entry at(const std::size_t idx) const {
+                  this->settle();
+                  const auto &r = this->records[idx];
+                  return stored_entry{this->opcodes[idx], stored_instruction{r.mnemonic, r.hint, operand_span(this->operands.data() + r.first_operand, r.num_operands)}};
+            }
+
+            stored_entry front() const {
+                  return this->at(0u);
+            }
+
+            stored_entry back() const {
+                  return this->at(this->size() - 1u);
+            }
+
+            const_iterator begin() const {
+                  return const_iterator(this, 0u);
+            }
+
+            const_iterator end() const {
+                  return const_iterator(this, this->size());
+            }
+
+            std::size_t size() const {
+                  this->settle();
+                  return this->opcodes.size();
+            }
+
+            /* Operands of every instruction */
+            std::size_t operand_count() const {
+                  return this->operands.size();
+            }
+
+            bool empty() const {
+                  return this->size() == 0u;
+            }
+
+            /* Opcodes are first, first + 1, ... */
+            bool contiguous() const {
+                  this->settle();
+                  return this->dense;
+            }
+
+            /* Heap bytes of the opcode and record arrays */
+            std::size_t instruction_bytes() const {
+                  this->settle();
+                  return this->opcodes.capacity() * sizeof(std::intptr_t) + this->records.capacity() * sizeof(record);
+            }
+
+            /* Heap bytes of the pooled operand array */
+            std::size_t operand_bytes() const {
+                  return this->operands.capacity() * sizeof(interned_operand);
+            }
+
+            void reserve(const std::size_t instructions, const std::size_t operands) {
+                  this->opcodes.reserve(instructions);
+                  this->records.reserve(instructions);
+                  this->operands.reserve(operands);
                   return;
             }
 
-#pragma endregion
+            void clear() {
+                  this->opcodes.clear();
+                  this->records.clear();
+                  this->operands.clear();
+                  this->pending.clear();
+                  this->ordered = 0u;
+                  this->dense = true;
+                  return;
+            }
 
-#pragma region file
+          private:
+            struct record {
+                  symbol mnemonic;
+                  symbol hint;
+                  std::uint32_t first_operand;
+                  std::uint32_t num_operands;
+            };
 
-            /* Save instruction set to file. */
-            void save(const std::string &dir);
+            /* Opcodes are first, first + 1, ..., in unsigned arithmetic as opcodes far apart would overflow intptr_t. */
+            bool span() const {
+                  return this->opcodes.empty() || static_cast<std::uintptr_t>(this->opcodes.back()) - static_cast<std::uintptr_t>(this->opcodes.front()) == this->opcodes.size() - 1u;
+            }
 
-            /* Load instruction set from file. */
-            void load(const std::string &dir);
+            /* Merge out of order inserts into opcode order, one sort of the tail and one merge instead of a shift per insert. */
+            void settle() const {
+                  this->merged.refresh([this]() {
+                        if (this->ordered == this->opcodes.size()) {
+                              return;
+                        }
+                        std::vector<std::size_t> order(this->opcodes.size());
+                        for (std::size_t idx = 0u; idx < order.size(); ++idx) {
+                              order[idx] = idx;
+                        }
+                        const auto by_opcode = [this](const std::size_t a, const std::size_t b) {
+                              return this->opcodes[a] < this->opcodes[b];
+                        };
+                        const auto middle = order.begin() + static_cast<std::ptrdiff_t>(this->ordered);
+                        std::sort(middle, order.end(), by_opcode);
+                        std::inplace_merge(order.begin(), middle, order.end(), by_opcode);
+
+                        std::vector<std::intptr_t> opcodes;
+                        std::vector<record> records;
+                        opcodes.reserve(this->opcodes.capacity());
+                        records.reserve(this->records.capacity());
+                        for (const auto idx : order) {
+                              opcodes.push_back(this->opcodes[idx]);
+                              records.push_back(this->records[idx]);
+                        }
+                        this->opcodes.swap(opcodes);
+                        this->records.swap(records);
+                        std::unordered_set<std::intptr_t>().swap(this->pending);
+                        this->ordered = this->opcodes.size();
+                        this->dense = this->span();
+                  });
+                  return;
+            }
+
+            /* Readers merge through settle(), so the order dependent members change under const. */
+            mutable std::vector<std::intptr_t> opcodes;
+            mutable std::vector<record> records;
+            std::vector<interned_operand> operands; /* Never reordered, records index into it. */
+            mutable std::unordered_set<std::intptr_t> pending; /* Opcodes past ordered, for duplicate checks before the merge */
+            mutable std::size_t ordered = 0u;                  /* Leading opcodes in order, the rest wait for settle() */
+            mutable bool dense = true;
+            refresh_guard merged;
+      };
+
+      /* Operand inside an instruction_set, valid until the set is modified. */
+      class operand_ref {
+
+          public:
+            operand_ref(const symbol_pool *pool, const interned_operand *op)
+                : pool(pool), op(op) {
+            }
+
+            const std::string &operand_() const {
+                  return this->pool->str(this->op->operand_);
+            }
+
+            const std::string &encoding() const {
+                  return this->pool->str(this->op->encoding);
+            }
+
+            const std::string &size() const {
+                  return this->pool->str(this->op->size);
+            }
+
+            const std::string &hint() const {
+                  return this->pool->str(this->op->hint);
+            }
+
+            const std::string &kind() const {
+                  return this->pool->str(this->op->kind);
+            }
+
+            /* Width in bits */
+            std::size_t bits() const {
+                  return this->op->bits;
+            }
+
+          private:
+            const symbol_pool *pool;
+            const interned_operand *op;
+      };
+
+      /* Instruction inside an instruction_set, valid until the set is modified. */
+      class instruction_ref {
+
+          public:
+            instruction_ref()
+                : pool(nullptr), entry{0, stored_instruction{0u, 0u, operand_span(nullptr, 0u)}} {
+            }
+
+            instruction_ref(const symbol_pool *pool, const stored_entry &entry)
+                : pool(pool), entry(entry) {
+            }
+
+            std::intptr_t opcode() const {
+                  return this->entry.first;
+            }
+
+            const std::string &mnemonic() const {
+                  return this->pool->str(this->entry.second.mnemonic);
+            }
+
+            const std::string &hint() const {
+                  return this->pool->str(this->entry.second.hint);
+            }
+
+            /* Number of operands */
+            std::size_t size() const {
+                  return this->entry.second.operands.size();
+            }
+
+            operand_ref at(std::size_t idx) const {
+                  return operand_ref(this->pool, &this->entry.second.operands[idx]);
+            }
+
+          private:
+            const symbol_pool *pool;
+            stored_entry entry;
+      };
+
+      /* Non copying view of an instruction_set in opcode order, valid until the set is modified. */
+      class instruction_view {
+
+          public:
+            class const_iterator {
+
+                public:
+                  const_iterator(const instruction_view *view, std::size_t idx)
+                      : view(view), idx(idx) {
+                  }
+
+                  instruction_ref operator*() const {
+                        return this->view->at(this->idx);
+                  }
+
+                  const_iterator &operator++() {
+                        ++this->idx;
+                        return *this;
+                  }
+
+                  bool operator==(const const_iterator &other) const {
+                        return this->idx == other.idx;
+                  }
+
+                  bool operator!=(const const_iterator &other) const {
+                        return this->idx != other.idx;
+                  }
+
+                private:
+                  const instruction_view *view;
+                  std::size_t idx;
+            };
+
+            instruction_view(const symbol_pool *pool, const instruction_store *store)
+                : pool(pool), store(store) {
+            }
+
+            /* Number of instructions */
+            std::size_t size() const {
+                  return this->store->size();
+            }
+
+            bool empty() const {
+                  return this->store->empty();
+            }
+
+            /* Instruction by position, ordered by opcode. */
+            instruction_ref at(std::size_t idx) const {
+                  return instruction_ref(this->pool, this->store->at(idx));
+            }
+
+            /* Instruction by opcode */
+            bool find(std::intptr_t opcode, instruction_ref &out) const {
+                  const auto idx = this->store->find(opcode);
+                  if (idx == instruction_store::npos) {
+                        return false;
+                  }
+                  out = this->at(idx);
+                  return true;
+            }
+
+            const_iterator begin() const {
+                  return const_iterator(this, 0u);
+            }
+
+            const_iterator end() const {
+                  return const_iterator(this, this->store->size());
+            }
+
+          private:
+            const symbol_pool *pool;
+            const instruction_store *store;
+      };
+
+      /* Instructions matching an index query in opcode order, valid until the set is modified. */
+      class instruction_query {
+
+          public:
+            class const_iterator {
+
+                public:
+                  const_iterator(const instruction_query *query, std::size_t idx)
+                      : query(query), idx(idx) {
+                  }
+
+                  instruction_ref operator*() const {
+                        return this->query->at(this->idx);
+                  }
+
+                  const_iterator &operator++() {
+                        ++this->idx;
+                        return *this;
+                  }
+
+                  bool operator==(const const_iterator &other) const {
+                        return this->idx == other.idx;
+                  }
+
+                  bool operator!=(const const_iterator &other) const {
+                        return this->idx != other.idx;
+                  }
+
+                private:
+                  const instruction_query *query;
+                  std::size_t idx;
+            };
+
+            /* Null opcodes is an empty result */
+            instruction_query(const symbol_pool *pool, const instruction_store *store, const std::vector<std::intptr_t> *opcodes)
+                : pool(pool), store(store), opcodes(opcodes) {
+            }
+
+            /* Number of matches */
+            std::size_t size() const {
+                  return this->opcodes != nullptr ? this->opcodes->size() : 0u;
+            }
+
+            bool empty() const {
+                  return this->size() == 0u;
+            }
+
+            /* Opcode of match idx, cheaper than at when only opcodes are needed. */
+            std::intptr_t opcode(std::size_t idx) const {
+                  return (*this->opcodes)[idx];
+            }
+
+            instruction_ref at(std::size_t idx) const {
+                  return instruction_ref(this->pool, this->store->at(this->store->find((*this->opcodes)[idx])));
+            }
+
+            const_iterator begin() const {
+                  return const_iterator(this, 0u);
+            }
+
+            const_iterator end() const {
+                  return const_iterator(this, this->size());
+            }
+
+          private:
+            const symbol_pool *pool;
+            const instruction_store *store;
+            const std::vector<std::intptr_t> *opcodes;
+      };
+
+      /* Read only view of a file mapped into memory. */
+      class mapped_file {
+
+          public:
+            mapped_file(const std::string &dir);
+            ~mapped_file();
+
+            mapped_file(const mapped_file &) = delete;
+            mapped_file &operator=(const mapped_file &) = delete;
+
+            /* File could be opened, an empty file is open with no data. */
+            bool is_open() const {
+                  return this->open;
+            }
+
+            const char *data() const {
+                  return this->view;
+            }
+
+            std::size_t size() const {
+                  return this->length;
+            }
+
+          private:
+            const char *view = nullptr;
+            std::size_t length = 0u;
+            bool open = false;
+            void *handle = nullptr;
+            void *mapping = nullptr;
+      };
+
+      /* Operand size in bits ("8-Bits", "2-Bytes", "16"), 0 when it has no leading number. */
+      __inline std::size_t operand_bits(const std::string &size) {
+            std::size_t bits = 0u;
+            for (const auto c : size) {
+                  if (c < '0' || c > '9') {
+                        break;
+                  }
+                  bits = bits * 10u + static_cast<std::size_t>(c - '0');
+            }
+            if (size.find("Byte") != std::string::npos || size.find("byte") != std::string::npos) {
+                  bits *= 8u;
+            }
+            return bits;
+      }
+
+      /* 64 bit FNV-1a, strings are length prefixed so field boundaries count. */
+      class fnv1a {
+
+          public:
+            static constexpr std::uint64_t offset = 14695981039346656037ull;
+            static constexpr std::uint64_t prime = 1099511628211ull;
+
+            fnv1a &add(const void *data, const std::size_t size) {
+                  const auto *bytes = static_cast<const std::uint8_t *>(data);
+                  for (std::size_t idx = 0u; idx < size; ++idx) {
+                        this->hash = (this->hash ^ bytes[idx]) * prime;
+                  }
+                  return *this;
+            }
+
+            /* Little endian so hashes match across machines */
+            fnv1a &add(const std::uint64_t value) {
+                  for (auto shift = 0u; shift < 64u; shift += 8u) {
+                        this->hash = (this->hash ^ ((value >> shift) & 0xFFu)) * prime;
+                  }
+                  return *this;
+            }
+
+            fnv1a &add(const std::string &str) {
+                  return this->add(static_cast<std::uint64_t>(str.size())).add(str.data(), str.size());
+            }
+
+            std::uint64_t value() const {
+                  return this->hash;
+            }
+
+          private:
+            std::uint64_t hash = offset;
+      };
+
+      /* Heap bytes held by an instruction_set */
+      struct memory_breakdown {
+            std::size_t instructions = 0u; /* Opcode and instruction records */
+            std::size_t operands = 0u;     /* Pooled operands */
+            std::size_t strings = 0u;      /* Interned strings and their index, estimated */
+            std::size_t indexes = 0u;      /* Query posting lists and operand field lists */
+
+            std::size_t total() const {
+                  return this->instructions + this->operands + this->strings + this->indexes;
+            }
+      };
+
+      /* Phases recorded when ISCREATE_STATS is defined, tables covers the six single pass artifacts. */
+      enum class phase : std::uint8_t {
+            read,
+            parse, /* Includes the validate and insert phases it drives. */
+            validate,
+            insert,
+            write,
+            tables,
+            decoder,
+            bulk_decoder,
+            mnemonic_lookup,
+            packed_operands,
+            encoder,
+            formatter,
+            dispatch,
+            interpreter,
+            block_cache,
+            count
+      };
+
+      __inline const char *phase_name(const phase which) {
+            static const char *const names[] = {"read", "parse", "validate", "insert", "write", "tables", "decoder", "bulk_decoder", "mnemonic_lookup", "packed_operands", "encoder", "formatter", "dispatch", "interpreter", "block_cache"};
+            return which < phase::count ? names[static_cast<std::size_t>(which)] : "";
+      }
+
+      struct phase_stats {
+            std::uint64_t calls = 0u;
+            std::uint64_t nanoseconds = 0u;
+            std::uint64_t bytes = 0u;       /* Read for read, written for write and generators. */
+            std::uint64_t allocations = 0u; /* Allocations on the recording thread, from the installed allocation_counter */
+      };
+
+      struct set_stats {
+            phase_stats phases[static_cast<std::size_t>(phase::count)];
+            memory_breakdown memory;
+
+            phase_stats &operator[](const phase which) {
+                  return this->phases[static_cast<std::size_t>(which)];
+            }
+
+            const phase_stats &operator[](const phase which) const {
+                  return this->phases[static_cast<std::size_t>(which)];
+            }
+
+            /* Stats as one JSON object, phases are keyed by phase_name. */
+            std::string json() const {
+                  std::string retn = "{\"phases\": {";
+                  for (std::size_t idx = 0u; idx < static_cast<std::size_t>(phase::count); ++idx) {
+                        const auto &p = this->phases[idx];
+                        retn.append(idx != 0u ? ", \"" : "\"").append(phase_name(static_cast<phase>(idx))).append("\": {\"calls\": ").append(std::to_string(p.calls));
+                        retn.append(", \"nanoseconds\": ").append(std::to_string(p.nanoseconds)).append(", \"bytes\": ").append(std::to_string(p.bytes));
+                        retn.append(", \"allocations\": ").append(std::to_string(p.allocations)).append("}");
+                  }
+                  retn.append("}, \"memory\": {\"instructions\": ").append(std::to_string(this->memory.instructions)).append(", \"operands\": ").append(std::to_string(this->memory.operands));
+                  retn.append(", \"strings\": ").append(std::to_string(this->memory.strings)).append(", \"indexes\": ").append(std::to_string(this->memory.indexes));
+                  retn.append(", \"total\": ").append(std::to_string(this->memory.total())).append("}}");
+                  return retn;
+            }
+      };
+
+#if defined(ISCREATE_STATS)
+      /* Running totals of one phase, relaxed atomics so generators running concurrently on one set can record. */
+      struct phase_counters {
+            std::atomic<std::uint64_t> calls{0u};
+            std::atomic<std::uint64_t> nanoseconds{0u};
+            std::atomic<std::uint64_t> bytes{0u};
+            std::atomic<std::uint64_t> allocations{0u};
+
+            void add(const phase_stats &delta) {
+                  this->calls.fetch_add(delta.calls, std::memory_order_relaxed);
+                  this->nanoseconds.fetch_add(delta.nanoseconds, std::memory_order_relaxed);
+                  this->bytes.fetch_add(delta.bytes, std::memory_order_relaxed);
+                  this->allocations.fetch_add(delta.allocations, std::memory_order_relaxed);
+                  return;
+            }
+
+            phase_stats load() const {
+                  phase_stats retn;
+                  retn.calls = this->calls.load(std::memory_order_relaxed);
+                  retn.nanoseconds = this->nanoseconds.load(std::memory_order_relaxed);
+                  retn.bytes = this->bytes.load(std::memory_order_relaxed);
+                  retn.allocations = this->allocations.load(std::memory_order_relaxed);
+                  return retn;
+            }
+
+            void store(const phase_stats &value) {
+                  this->calls.store(value.calls, std::memory_order_relaxed);
+                  this->nanoseconds.store(value.nanoseconds, std::memory_order_relaxed);
+                  this->bytes.store(value.bytes, std::memory_order_relaxed);
+                  this->allocations.store(value.allocations, std::memory_order_relaxed);
+                  return;
+            }
+      };
+
+      /* Counters of every phase, copies take the totals recorded so far. */
+      class stats_recorder {
+
+          public:
+            stats_recorder() = default;
+
+            stats_recorder(const stats_recorder &other) {
+                  *this = other;
+            }
+
+            stats_recorder &operator=(const stats_recorder &other) {
+                  for (std::size_t idx = 0u; idx < static_cast<std::size_t>(phase::count); ++idx) {
+                        this->phases[idx].store(other.phases[idx].load());
+                  }
+                  return *this;
+            }
+
+            phase_counters &operator[](const phase which) {
+                  return this->phases[static_cast<std::size_t>(which)];
+            }
+
+            /* Totals so far, phases still recording show up once they finish. */
+            set_stats load() const {
+                  set_stats retn;
+                  for (std::size_t idx = 0u; idx < static_cast<std::size_t>(phase::count); ++idx) {
+                        retn.phases[idx] = this->phases[idx].load();
+                  }
+                  return retn;
+            }
+
+            void reset() {
+                  for (auto &p : this->phases) {
+                        p.store(phase_stats());
+                  }
+                  return;
+            }
+
+          private:
+            phase_counters phases[static_cast<std::size_t>(phase::count)];
+      };
+
+      /* Returns the allocations the calling thread has made so far. The library never replaces the allocator,
+         an application that wants allocation counts keeps them itself, e.g. in its own operator new, and installs the counter. */
+      typedef std::uint64_t (*allocation_counter)();
+
+      /* Install counter for every phase to read, nullptr removes it and phases record 0 allocations. */
+      void set_allocation_counter(allocation_counter counter);
+
+      /* Allocations of the calling thread from the installed counter, 0 without one. */
+      std::uint64_t allocation_count();
+
+      /* Adds the time, allocations and sink bytes of its scope to one phase. */
+      class phase_timer {
+
+          public:
+            phase_timer(phase_counters &stats, const sink *out)
+                : stats(stats), out(out), bytes(out != nullptr ? out->written() : 0u), allocations(allocation_count()), start(std::chrono::steady_clock::now()) {
+            }
+
+            phase_timer(phase_counters &stats, const artifact_sinks &sinks)
+                : stats(stats), sinks(&sinks), bytes(sum(sinks)), allocations(allocation_count()), start(std::chrono::steady_clock::now()) {
+            }
+
+            phase_timer(const phase_timer &) = delete;
+            phase_timer &operator=(const phase_timer &) = delete;
+
+            ~phase_timer() {
+                  const auto stop = std::chrono::steady_clock::now();
+                  phase_stats delta;
+                  delta.calls = 1u;
+                  delta.nanoseconds = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - this->start).count());
+                  delta.allocations = allocation_count() - this->allocations;
+                  if (this->out != nullptr) {
+                        delta.bytes = this->out->written() - this->bytes;
+                  } else if (this->sinks != nullptr) {
+                        delta.bytes = sum(*this->sinks) - this->bytes;
+                  }
+                  this->stats.add(delta);
+            }
+
+          private:
+            static std::size_t sum(const artifact_sinks &sinks) {
+                  std::size_t retn = 0u;
+                  for (const auto *s : {sinks.enum_opcodes, sinks.enum_opencodings, sinks.enum_opkinds, sinks.opencodings, sinks.opkinds, sinks.opdescriptors}) {
+                        retn += s != nullptr ? s->written() : 0u;
+                  }
+                  return retn;
+            }
+
+            phase_counters &stats;
+            const sink *out = nullptr;
+            const artifact_sinks *sinks = nullptr;
+            std::size_t bytes = 0u;
+            std::uint64_t allocations = 0u;
+            std::chrono::steady_clock::time_point start;
+      };
+
+/* Time the rest of the scope as a phase, out is a sink, artifact_sinks or nullptr. */
+#define ISCREATE_PHASE(stats, out) const iscreate::phase_timer iscreate_phase_timer((stats), (out))
+#define ISCREATE_BYTES(stats, n) ((stats).bytes.fetch_add(static_cast<std::uint64_t>(n), std::memory_order_relaxed))
+#else
+#define ISCREATE_PHASE(stats, out)
+#define ISCREATE_BYTES(stats, n)
+#endif
+
+      class instruction_set {
+
+          public:
+            instruction_set(const std::string &name)
+                : name(name) {
+            }
+
+#pragma region add
+
+            /* Add instruction */
+            template <std::intptr_t opcode>
+            void add(const std::string &mnemonic, const std::string &hint) {
+                  this->insert(opcode, mnemonic, hint, std::vector<operand>());
+                  return;
+            }
+
+            /* Add instruction */
+            void add(const std::intptr_t opcode, const std::string &mnemonic, const std::string &hint, const std::vector<operand> &operands) {
+                  this->insert(opcode, mnemonic, hint, operands);
+                  return;
+            }
+
+            /* Add instruction */
+            template <std::intptr_t opcode>
+            void add(const std::string &mnemonic, const std::string &hint, const std::vector<operand> &operands) {
+                  this->insert(opcode, mnemonic, hint, operands);
+                  return;
+            }
+
+            /* Add instruction */
+            void add(const std::string &mnemonic, const std::string &hint, const std::vector<operand> &operands) {
+                  this->insert(!this->instructions.empty() ? this->instructions.back().first + 1u : 0u, mnemonic, hint, operands);
+                  return;
+            }
+
+            /* Add instruction */
+            void add(const std::string &mnemonic, const std::string &hint) {
+                  this->insert(!this->instructions.empty() ? this->instructions.back().first + 1u : 0u, mnemonic, hint, std::vector<operand>());
+                  return;
+            }
+
+            /* Add instruction, new strings are moved into the set instead of copied. */
+            void add(const std::intptr_t opcode, std::string &&mnemonic, std::string &&hint, std::vector<operand> &&operands) {
+                  this->insert(opcode, std::move(mnemonic), std::move(hint), std::move(operands));
+                  return;
+            }
+
+            /* Add instruction */
+            void add(const std::intptr_t opcode, const instruction &inst) {
+                  this->insert(opcode, inst.mnemonic, inst.hint, inst.operands);
+                  return;
+            }
+
+            /* Add instruction, new strings are moved into the set instead of copied. */
+            void add(const std::intptr_t opcode, instruction &&inst) {
+                  this->insert(opcode, std::move(inst.mnemonic), std::move(inst.hint), std::move(inst.operands));
+                  return;
+            }
+
+            /* Add opcode and instruction pairs in any order, e.g. a std::map from data() or a vector of pairs.
+               Storage is reserved once and instructions are appended in opcode order, the first of duplicate opcodes is kept.
+               Strings are moved out of an rvalue range. */
+            template <typename range>
+            void add_bulk(range &&instructions) {
+
+                  constexpr auto movable = !std::is_lvalue_reference_v<range>;
+
+                  /* Opcode order, stable so duplicates keep input order */
+                  std::vector<decltype(&*std::begin(instructions))> order;
+                  std::size_t operands = 0u;
+                  for (auto &entry : instructions) {
+                        order.push_back(&entry);
+                        operands += entry.second.operands.size();
+                  }
+                  const auto by_opcode = [](const auto *a, const auto *b) {
+                        return static_cast<std::intptr_t>(a->first) < static_cast<std::intptr_t>(b->first);
+                  };
+                  if (!std::is_sorted(order.begin(), order.end(), by_opcode)) {
+                        std::stable_sort(order.begin(), order.end(), by_opcode);
+                  }
+
+                  this->reserve(this->instructions.size() + order.size(), this->instructions.operand_count() + operands);
+                  for (auto *entry : order) {
+                        if constexpr (movable) {
+                              this->insert(static_cast<std::intptr_t>(entry->first), std::move(entry->second.mnemonic), std::move(entry->second.hint), std::move(entry->second.operands));
+                        } else {
+                              this->insert(static_cast<std::intptr_t>(entry->first), entry->second.mnemonic, entry->second.hint, entry->second.operands);
+                        }
+                  }
+                  return;
+            }
+
+            /* Reserve room for a total of instructions and operands, avoids regrowth while adding many. */
+            void reserve(const std::size_t instructions, const std::size_t operands = 0u) {
+                  this->instructions.reserve(instructions, operands);
+                  return;
+            }
+
+#pragma endregion
+
+#pragma region file
+
+            /* Save instruction set to file. */
+            void save(const std::string &dir);
+
+            /* Save instruction set to stream. */
+            void save(std::ostream &out);
+
+            /* Load instruction set from file. */
+            void load(const std::string &dir) {
+                  this->try_load(dir);
+                  return;
+            }
+
+            /* Load instruction set from file, false when it cannot be read or is not a valid spec. Instructions added before the error are kept. */
+            bool try_load(const std::string &dir);
+
+            /* Save instruction set to compiled binary file. */
+            void save_binary(const std::string &dir);
+
+            /* Load instruction set from compiled binary file. */
+            void load_binary(const std::string &dir);
+
+#pragma endregion
+
+#pragma region represent
+
+#pragma region single pass
+
+            /* Create every selected artifact in one walk over the instructions. */
+            template <language lang = language::cpp, table mode = table::map>
+            artifacts represent(const std::uint8_t which = artifact::all) {
+
+                  artifacts retn;
+
+                  /* String sinks for the selected artifacts, flushed before the strings are returned. */
+                  std::vector<sink> sinks;
+                  sinks.reserve(6u);
+                  artifact_sinks out;
+                  const auto select = [&](const std::uint8_t a, std::string &str, sink *&target) {
+                        if ((which & a) != 0u) {
+                              sinks.push_back(create_sink(str));
+                              target = &sinks.back();
+                        }
+                  };
+                  select(artifact::enum_opcodes, retn.enum_opcodes, out.enum_opcodes);
+                  select(artifact::enum_opencodings, retn.enum_opencodings, out.enum_opencodings);
+                  select(artifact::enum_opkinds, retn.enum_opkinds, out.enum_opkinds);
+                  select(artifact::opencodings, retn.opencodings, out.opencodings);
+                  select(artifact::opkinds, retn.opkinds, out.opkinds);
+                  select(artifact::opdescriptors, retn.opdescriptors, out.opdescriptors);
+
+                  this->represent<lang, mode>(out);
+                  for (auto &s : sinks) {
+                        s.flush();
+                  }
+
+                  return retn;
+            }
+
+            /* Stream every selected artifact in one walk over the instructions, rows are written as they are created. */
+            template <language lang = language::cpp, table mode = table::map>
+            void represent(const artifact_sinks &sinks) {
+
+                  ISCREATE_PHASE(this->statistics[phase::tables], sinks);
+
+                  /* Nothing */
+                  if (this->instructions.empty()) {
+                        return;
+                  }
+
+                  /* See if every entry increases by 1 from 0, indexing by opcode is only safe then. */
+                  const auto set = this->instructions.contiguous() && this->instructions.front().first == 0;
+                  const auto flat = mode == table::flat && set;
+
+                  const auto &ops = this->opcodes_enum_name;
+                  const auto &encs = this->opencodings_enum_name;
+                  const auto &kinds = this->opkinds_enum_name;
+
+                  /* Operand enums come straight from the pool */
+                  const auto distinct = [&](const std::vector<symbol> &analyzed, const std::string &enum_name, sink &out) {
+                        switch (lang) {
+                              case language::cpp: {
+                                    out.append("enum class ").append(enum_name).append(" {\n");
+                                    break;
+                              }
+                              case language::c: {
+                                    out.append("typedef enum {\n");
+                                    break;
+                              }
+                              default: {
+                                    break;
+                              }
+                        }
+                        for (auto idx = 0u; idx < analyzed.size(); ++idx) {
+                              out.append("   ").append(this->str(analyzed[idx])).append(idx != analyzed.size() - 1u ? ",\n" : "\n");
+                        }
+                        switch (lang) {
+                              case language::cpp: {
+                                    out.append("};");
+                                    break;
+                              }
+                              case language::c: {
+                                    out.append("} ").append(enum_name).append(";");
+                                    break;
+                              }
+                              default: {
+                                    break;
+                              }
+                        }
+                  };
+                  if (sinks.enum_opencodings != nullptr) {
+                        distinct(this->encodings, encs, *sinks.enum_opencodings);
+                  }
+                  if (sinks.enum_opkinds != nullptr) {
+                        distinct(this->kinds, kinds, *sinks.enum_opkinds);
+                  }
+
+                  /* Opcode enum definition */
+                  if (sinks.enum_opcodes != nullptr) {
+                        switch (lang) {
+                              case language::cpp: {
+                                    sinks.enum_opcodes->append("enum class ").append(ops).append(" {\n");
+                                    break;
+                              }
+                              case language::c: {
+                                    sinks.enum_opcodes->append("typedef enum {\n");
+                                    break;
+                              }
+                              default: {
+                                    break;
+                              }
+                        }
+                  }
+
+                  /* Table definitions, flat tables get their operand pool after the rows. */
+                  const auto head = [&](sink *out, const char *table_name, const char *structure_name, const std::string &structure, const std::string &map_structure) {
+                        if (out == nullptr) {
+                              return;
+                        }
+                        if (flat) {
+                              out->append(structure);
+                              switch (lang) {
+                                    case language::cpp: {
+                                          out->append("static constexpr ").append(structure_name).append(" ").append(table_name).append("[] = {\n");
+                                          break;
+                                    }
+                                    case language::c: {
+                                          out->append("static const struct ").append(structure_name).append(" ").append(table_name).append("[] = {\n");
+                                          break;
+                                    }
+                                    default: {
+                                          break;
+                                    }
+                              }
+                        } else {
+                              out->append(map_structure);
+                        }
+                  };
+
+                  switch (lang) {
+                        case language::cpp: {
+                              head(sinks.opencodings, "opencodings", "optable_encoding", "struct optable_encoding {\n\
+   " + ops + " op;\n\
+   std::size_t first_encoding;\n\
+   std::size_t num_encodings;\n\
+};\n",
+                                   "struct optable_encoding {\n\
+   " + ops + " op;\n\
+   std::vector<operand_encoding> encodings;\n\
+};\n\
+static std::map<" + ops + ", optable_encoding> opencodings = {\n");
+                              head(sinks.opkinds, "opkinds", "optable_kind", "struct optable_kind {\n\
+   " + ops + " op;\n\
+   std::size_t first_kind;\n\
+   std::size_t num_kinds;\n\
+};\n",
+                                   "struct optable_kind {\n\
+   " + ops + " op;\n\
+   std::vector<operand_kind> kinds;\n\
+};\n\
+static std::map<" + ops + ", optable_kind> opkinds = {\n");
+                              head(sinks.opdescriptors, "opdescriptor", "optable_descriptor", "struct optable_descriptor {\n\
+   const char * opname;\n\
+   const char * mnemonic;\n\
+   const char * hint;\n\
+   std::size_t first_operand_encoding;\n\
+   std::size_t num_operand_encoding;\n\
+};\n",
+                                   "struct optable_descriptor {\n\
+   const char * opname;\n\
+   const char * mnemonic;\n\
+   const char * hint;\n\
+   std::vector<const char *> operand_encodings;\n\
+};\n\
+static std::map<" + ops + ", optable_descriptor> opdescriptor = {\n");
+                              break;
+                        }
+                        case language::c: {
+                              head(sinks.opencodings, "opencodings", "optable_encoding", "struct optable_encoding {\n\
+   " + ops + " op;\n\
+   size_t first_encoding;\n\
+   size_t num_encodings;\n\
+};\n",
+                                   "struct optable_encoding {\n\
+   " + ops + " op;\n\
+   operand_encoding []encodings;\n\
+   size_t num_encodings;\n\
+};\n\
+static struct optable_encoding opencodings[] = {\n");
+                              head(sinks.opkinds, "opkinds", "optable_kind", "struct optable_kind {\n\
+   " + ops + " op;\n\
+   size_t first_kind;\n\
+   size_t num_kinds;\n\
+};\n",
+                                   "struct optable_kind {\n\
+   " + ops + " op;\n\
+   operand_encoding []kinds;\n\
+   size_t num_kinds;\n\
+};\n\
+static struct optable_kind opkinds[] = {\n");
+                              head(sinks.opdescriptors, "opdescriptor", "optable_descriptor", "struct optable_descriptor {\n\
+   const char * opname;\n\
+   const char * mnemonic;\n\
+   const char * hint;\n\
+   size_t first_operand_encoding;\n\
+   size_t num_operand_encoding;\n\
+};\n",
+                                   "struct optable_descriptor {\n\
+   const char * opname;\n\
+   const char * mnemonic;\n\
+   const char * hint;\n\
+   const char* []operand_encodings;\n\
+   size_t num_operand_encoding;\n\
+};\n\
+static struct optable_descriptor opdescriptor[] = {\n");
+                              break;
+                        }
+                        default: {
+                              break;
+                        }
+                  }
+
+                  /* Derived per instruction data, built once and shared by every artifact. */
+                  std::string name = "";
+                  std::string hex = "";
+                  std::size_t pooled = 0u;
+
+                  for (const auto &inst : this->instructions) {
+
+                        const auto last = inst.first == this->instructions.back().first;
+                        const auto &mnemonic = this->str(inst.second.mnemonic);
+                        const auto &hint = this->str(inst.second.hint);
+                        const auto &operands = inst.second.operands;
+                        const auto n = operands.size();
+
+                        /* Capatalize */
+                        name.clear();
+                        this->append_enumerator(name, mnemonic);
+
+                        /* Hex opcode */
+                        hex.clear();
+                        auto value = static_cast<std::uintptr_t>(inst.first);
+                        do {
+                              hex += "0123456789abcdef"[value & 0xFu];
+                              value >>= 4u;
+                        } while (value != 0u);
+                        std::reverse(hex.begin(), hex.end());
+
+                        if (sinks.enum_opcodes != nullptr) {
+                              auto &out = *sinks.enum_opcodes;
+                              out.append("   ").append(name);
+                              if (!set) {
+                                    out.append(" = ").append(std::to_string(inst.first));
+                              }
+                              out.append(!last ? "," : "").append(" /* (").append(hex).append(")");
+                              if (!hint.empty()) {
+                                    out.append(" | ").append(hint);
+                              }
+                              if (n != 0u) {
+                                    out.append(" | ");
+                              }
+                              for (auto idx = 0u; idx < n; ++idx) {
+                                    out.append("* ").append(this->str(operands[idx].operand_)).append("(").append(this->str(operands[idx].size)).append(")").append(idx != n - 1u ? ", " : "");
+                              }
+                              out.append(" */\n");
+                        }
+
+                        if (sinks.opencodings != nullptr) {
+                              auto &out = *sinks.opencodings;
+                              switch (lang) {
+                                    case language::c: {
+                                          if (flat) { /* {??, 0, 1} */
+                                                out.append("   {").append(name).append(", ").append(std::to_string(pooled)).append(", ").append(std::to_string(n)).append(!last ? "}," : "}");
+                                                break;
+                                          }
+                                          /* {??, {??, {??, ??}}} 1 */
+                                          out.append("   {").append(name).append(", {");
+                                          for (auto idx = 0u; idx < n; ++idx) {
+                                                out.append(this->str(operands[idx].encoding)).append(idx != n - 1u ? ", " : "");
+                                          }
+                                          out.append("}, ").append(std::to_string(n)).append(!last ? "}," : "}");
+                                          break;
+                                    }
+                                    case language::cpp: {
+                                          if (flat) { /* {opcodes::??, 0, 1} */
+                                                out.append("   {").append(ops).append("::").append(name).append(", ").append(std::to_string(pooled)).append(", ").append(std::to_string(n)).append(!last ? "}," : "}");
+                                                break;
+                                          }
+                                          /* {opcodes::??, {opcodes::??, {operand_encoding::??, operand_encoding::??}}} 1 */
+                                          out.append("   {").append(ops).append("::").append(name).append(", {").append(ops).append("::").append(name).append(", {");
+                                          for (auto idx = 0u; idx < n; ++idx) {
+                                                out.append(encs).append("::").append(this->str(operands[idx].encoding)).append(idx != n - 1u ? ", " : "");
+                                          }
+                                          out.append("}}}").append(!last ? "," : "");
+                                          break;
+                                    }
+                                    default: {
+                                          break;
+                                    }
+                              }
+                              out.append(" /* ").append(hex).append(" */\n");
+                        }
+
+                        if (sinks.opkinds != nullptr) {
+                              auto &out = *sinks.opkinds;
+                              switch (lang) {
+                                    case language::c: {
+                                          if (flat) { /* {??, 0, 1} */
+                                                out.append("   {").append(name).append(", ").append(std::to_string(pooled)).append(", ").append(std::to_string(n)).append(!last ? "}," : "}");
+                                                break;
+                                          }
+                                          /* {??, {??, ??}}, 1 */
+                                          out.append("   {").append(name).append(", {");
+                                          for (auto idx = 0u; idx < n; ++idx) {
+                                                out.append(this->str(operands[idx].kind)).append(idx != n - 1u ? ", " : "");
+                                          }
+                                          out.append("}, ").append(std::to_string(n)).append(!last ? "}," : "}");
+                                          break;
+                                    }
+                                    case language::cpp: {
+                                          if (flat) { /* {opcodes::??, 0, 1} */
+                                                out.append("   {").append(ops).append("::").append(name).append(", ").append(std::to_string(pooled)).append(", ").append(std::to_string(n)).append(!last ? "}," : "}");
+                                                break;
+                                          }
+                                          /* {opcodes::??, {opcodes::??, {operand_kind::??, operand_kind::??}}}, 1 */
+                                          out.append("   {").append(ops).append("::").append(name).append(", {").append(ops).append("::").append(name).append(", {");
+                                          for (auto idx = 0u; idx < n; ++idx) {
+                                                out.append(kinds).append("::").append(this->str(operands[idx].kind)).append(idx != n - 1u ? ", " : "");
+                                          }
+                                          out.append("}}}").append(!last ? "," : "");
+                                          break;
+                                    }
+                                    default: {
+                                          break;
+                                    }
+                              }
+                              out.append(" /* ").append(hex).append(" */\n");
+                        }
+
+                        if (sinks.opdescriptors != nullptr) {
+                              auto &out = *sinks.opdescriptors;
+                              if (flat) { /* {"??", "??", "??", 0, 1} */
+                                    out.append("   {\"").append(name).append("\", \"").append(mnemonic).append("\", \"").append(hint).append("\", ").append(std::to_string(pooled)).append(", ").append(std::to_string(n)).append(!last ? "}," : "}");
+                              } else {
+                                    switch (lang) {
+                                          case language::c: { /* {??, {??, ??}}, 1 */
+                                                out.append("   {").append(name);
+                                                break;
+                                          }
+                                          case language::cpp: { /* {opcodes::??, {opcodes::??, {operand_kind::??, operand_kind::??}}}, 1 */
+                                                out.append("   {").append(ops).append("::").append(name);
+                                                break;
+                                          }
+                                          default: {
+                                                break;
+                                          }
+                                    }
+                                    out.append(", {\"").append(name).append("\", \"").append(mnemonic).append("\", \"").append(hint).append("\", {");
+                                    for (auto idx = 0u; idx < n; ++idx) {
+                                          out.append("\"").append(this->str(operands[idx].operand_)).append("(").append(this->str(operands[idx].hint)).append(")\"").append(idx != n - 1u ? ", " : "");
+                                    }
+                                    switch (lang) {
+                                          case language::c: {
+                                                out.append("}, ").append(std::to_string(n)).append(!last ? "}," : "}");
+                                                break;
+                                          }
+                                          case language::cpp: {
+                                                out.append("}}}").append(!last ? "," : "");
+                                                break;
+                                          }
+                                          default: {
+                                                break;
+                                          }
+                                    }
+                              }
+                              out.append(" /* ").append(hex).append(" */\n");
+                        }
+
+                        pooled += n;
+                  }
+
+                  /* Opcode enum footer */
+                  if (sinks.enum_opcodes != nullptr) {
+                        switch (lang) {
+                              case language::cpp: {
+                                    sinks.enum_opcodes->append("};");
+                                    break;
+                              }
+                              case language::c: {
+                                    sinks.enum_opcodes->append("} ").append(ops).append(";");
+                                    break;
+                              }
+                              default: {
+                                    break;
+                              }
+                        }
+                  }
+
+                  /* Close the tables, flat ones are followed by their operand pool from a second walk. */
+                  const auto pool_count = std::to_string(pooled != 0u ? pooled : 1u);
+                  const auto tail = [&](sink *out, const char *table_name, const std::string &element, const auto &entry) {
+                        if (out == nullptr) {
+                              return;
+                        }
+                        out->append("};");
+                        if (!flat) {
+                              return;
+                        }
+                        switch (lang) {
+                              case language::cpp: {
+                                    out->append("\nstatic constexpr ").append(element).append(" ").append(table_name).append("_operands[").append(pool_count).append("] = {\n");
+                                    break;
+                              }
+                              case language::c: {
+                                    out->append("\nstatic const ").append(element).append(" ").append(table_name).append("_operands[").append(pool_count).append("] = {\n").append(pooled != 0u ? "" : "   0");
+                                    break;
+                              }
+                              default: {
+                                    break;
+                              }
+                        }
+                        auto first = true;
+                        for (const auto &inst : this->instructions) {
+                              const auto &operands = inst.second.operands;
+                              const auto n = operands.size();
+                              out->append(n != 0u ? (!first ? ",\n   " : "   ") : "");
+                              for (auto idx = 0u; idx < n; ++idx) {
+                                    entry(*out, operands[idx]);
+                                    out->append(idx != n - 1u ? ", " : "");
+                              }
+                              first = first && n == 0u;
+                        }
+                        out->append("\n};");
+                  };
+
+                  tail(sinks.opencodings, "opencodings", encs, [&](sink &out, const interned_operand &op) {
+                        if (lang == language::cpp) {
+                              out.append(encs).append("::");
+                        }
+                        out.append(this->str(op.encoding));
+                  });
+                  tail(sinks.opkinds, "opkinds", kinds, [&](sink &out, const interned_operand &op) {
+                        if (lang == language::cpp) {
+                              out.append(kinds).append("::");
+                        }
+                        out.append(this->str(op.kind));
+                  });
+                  tail(sinks.opdescriptors, "opdescriptor", lang == language::cpp ? "const char *" : "char * const", [&](sink &out, const interned_operand &op) {
+                        out.append("\"").append(this->str(op.operand_)).append("(").append(this->str(op.hint)).append(")\"");
+                  });
+
+                  return;
+            }
+
+#pragma endregion
+
+#pragma region enums
+
+            /* Create opcode enum */
+            template <language lang = language::cpp>
+            std::string represent_enum_opcodes() {
+                  return this->represent<lang>(artifact::enum_opcodes).enum_opcodes;
+            }
+
+            /* Create operand encoding enum */
+            template <language lang = language::cpp>
+            std::string represent_enum_opencodings() {
+                  return this->represent<lang>(artifact::enum_opencodings).enum_opencodings;
+            }
+
+            /* Create operand kind enum */
+            template <language lang = language::cpp>
+            std::string represent_enum_opkinds() {
+                  return this->represent<lang>(artifact::enum_opkinds).enum_opkinds;
+            }
+
+#pragma endregion
+
+#pragma region arrays
+
+            /* Create opcode encoding table */
+            template <language lang = language::cpp, table mode = table::map>
+            std::string represent_opencodings() {
+                  return this->represent<lang, mode>(artifact::opencodings).opencodings;
+            }
+
+            /* Create opcode kind table */
+            template <language lang = language::cpp, table mode = table::map>
+            std::string represent_opkinds() {
+                  return this->represent<lang, mode>(artifact::opkinds).opkinds;
+            }
+
+            /* Create opcode descriptor table */
+            template <language lang = language::cpp, table mode = table::map>
+            std::string represent_opdescriptors() {
+                  return this->represent<lang, mode>(artifact::opdescriptors).opdescriptors;
+            }
+
+#pragma endregion
+
+#pragma region decoder
+
+            /* Create batch decoder, opcodes and operands are read little endian with operand widths from their size. */
+            template <language lang = language::cpp>
+            std::string represent_decoder() {
+                  std::string retn = "";
+                  sink out = create_sink(retn);
+                  this->represent_decoder<lang>(out);
+                  out.flush();
+                  return retn;
+            }
+
+            /* Stream batch decoder, table rows are written as they are created. */
+            template <language lang = language::cpp>
+            void represent_decoder(sink &out) {
+
+                  ISCREATE_PHASE(this->statistics[phase::decoder], &out);
+
+                  std::string lengths_head = "";
+                  std::string widths_head = "";
+                  std::string definition = "";
+                  std::string footer = "";
+                  std::string retn = "";
+
+                  /* Nothing */
+                  if (this->instructions.empty()) {
+                        return;
+                  }
+
+                  /* Opcodes index the decode tables directly. */
+                  const auto high = this->instructions.back().first;
+                  if (this->instructions.front().first < 0 || high > 0xFFFF) {
+                        std::cerr << "Decoder requires opcodes between 0 and 0xFFFF." << std::endl;
+                        return;
+                  }
+
+                  /* One byte opcodes get a full table so the range check disappears. */
+                  const std::size_t opbytes = high > 0xFF ? 2u : 1u;
+                  const std::size_t entries = opbytes == 1u ? 0x100u : static_cast<std::size_t>(high) + 1u;
+
+                  /* Widest operand list, widest operand and longest instruction */
+                  std::size_t slots = 1u;
+                  std::size_t widest = 0u;
+                  std::size_t longest = 0u;
+                  for (const auto &inst : this->instructions) {
+                        std::size_t length = opbytes;
+                        for (const auto &op : inst.second.operands) {
+                              const std::size_t bytes = (op.bits + 7u) / 8u;
+                              widest = std::max(widest, bytes);
+                              length += bytes;
+                        }
+                        slots = std::max(slots, inst.second.operands.size());
+                        longest = std::max(longest, length);
+                  }
+
+                  /* Lengths and widths get the smallest type that holds them. */
+                  const auto type = [](const std::size_t value) -> std::string {
+                        return value > 0xFFFFu ? "std::uint32_t" : (value > 0xFFu ? "std::uint16_t" : "std::uint8_t");
+                  };
+                  const auto cpp_length = type(longest);
+                  const auto c_length = cpp_length.substr(5u);
+                  const auto cpp_width = type(widest);
+                  const auto c_width = cpp_width.substr(5u);
+                  const auto count = std::to_string(entries);
+                  const auto slot_count = std::to_string(slots);
+
+                  /* Opcode fetch */
+                  const std::string fetch = opbytes == 1u ? "code[offset]" : "code[offset] | (code[offset + 1u] << 8u)";
+                  const std::string check = opbytes == 1u ? "decode_lengths[op]" : "op < " + count + "u ? decode_lengths[op] : 0u";
+
+                  /* Create definition */
+                  switch (lang) {
+                        case language::cpp: {
+                              lengths_head = "struct decoded_instruction {\n\
+   " + this->opcodes_enum_name + " op;\n\
+   " + cpp_length + " length;\n\
+   std::uint64_t operands[" + slot_count + "];\n\
+};\n\
+static constexpr " + cpp_length + " decode_lengths[" + count + "] = {\n";
+                              widths_head = "};\n\
+static constexpr " + cpp_width + " decode_widths[" + count + "][" + slot_count + "] = {\n";
+                              definition = "};\n\
+/* Decode up to count instructions, stops early on an unknown opcode or truncated instruction. */\n\
+static inline std::size_t decode(const std::uint8_t *code, std::size_t size, decoded_instruction *out, std::size_t count, std::size_t &consumed) {\n";
+                              break;
+                        }
+                        case language::c: {
+                              lengths_head = "typedef struct {\n\
+   " + this->opcodes_enum_name + " op;\n\
+   " + c_length + " length;\n\
+   uint64_t operands[" + slot_count + "];\n\
+} decoded_instruction;\n\
+static const " + c_length + " decode_lengths[" + count + "] = {\n";
+                              widths_head = "};\n\
+static const " + c_width + " decode_widths[" + count + "][" + slot_count + "] = {\n";
+                              definition = "};\n\
+/* Decode up to count instructions, stops early on an unknown opcode or truncated instruction. */\n\
+static inline size_t decode(const uint8_t *code, size_t size, decoded_instruction *out, size_t count, size_t *consumed) {\n";
+                              break;
+                        }
+                        default: {
+                              break;
+                        }
+                  }
+
+                  /* Create body */
+                  switch (lang) {
+                        case language::cpp: {
+                              retn = "   std::size_t offset = 0u;\n\
+   std::size_t n = 0u;\n\
+   for (; n < count && size - offset >= " + std::to_string(opbytes) + "u; ++n) {\n\
+      const std::size_t op = " + fetch + ";\n\
+      const std::size_t length = " + check + ";\n\
+      if (length == 0u || size - offset < length) {\n\
+         break;\n\
+      }\n\
+      const std::uint8_t *p = code + offset + " + std::to_string(opbytes) + "u;\n\
+      out[n].op = static_cast<" + this->opcodes_enum_name + ">(op);\n\
+      out[n].length = static_cast<" + cpp_length + ">(length);\n\
+      for (std::size_t k = 0u; k < " + slot_count + "u; ++k) {\n\
+         const std::size_t width = decode_widths[op][k];\n\
+         std::uint64_t value = 0u;\n\
+         for (std::size_t b = 0u; b < width && b < 8u; ++b) {\n\
+            value |= static_cast<std::uint64_t>(p[b]) << (8u * b);\n\
+         }\n\
+         out[n].operands[k] = value;\n\
+         p += width;\n\
+      }\n\
+      offset += length;\n\
+   }\n\
+   consumed = offset;\n\
+   return n;\n";
+                              break;
+                        }
+                        case language::c: {
+                              retn = "   size_t offset = 0u;\n\
+   size_t n = 0u;\n\
+   for (; n < count && size - offset >= " + std::to_string(opbytes) + "u; ++n) {\n\
+      const size_t op = " + fetch + ";\n\
+      const size_t length = " + check + ";\n\
+      if (length == 0u || size - offset < length) {\n\
+         break;\n\
+      }\n\
+      const uint8_t *p = code + offset + " + std::to_string(opbytes) + "u;\n\
+      out[n].op = (" + this->opcodes_enum_name + ")op;\n\
+      out[n].length = (" + c_length + ")length;\n\
+      for (size_t k = 0u; k < " + slot_count + "u; ++k) {\n\
+         const size_t width = decode_widths[op][k];\n\
+         uint64_t value = 0u;\n\
+         for (size_t b = 0u; b < width && b < 8u; ++b) {\n\
+            value |= (uint64_t)p[b] << (8u * b);\n\
+         }\n\
+         out[n].operands[k] = value;\n\
+         p += width;\n\
+      }\n\
+      offset += length;\n\
+   }\n\
+   *consumed = offset;\n\
+   return n;\n";
+                              break;
+                        }
+                        default: {
+                              break;
+                        }
+                  }
+
+                  /* Create footer */
+                  switch (lang) {
+                        case language::c:
+                        case language::cpp: {
+                              footer = "}";
+                              break;
+                        }
+                        default: {
+                              break;
+                        }
+                  }
+
+                  /* Width of operand idx, 0 past the operand list or for unused opcodes. */
+                  const auto width = [&](const auto &inst, const bool used, const std::size_t idx) -> std::size_t {
+                        return used && idx < inst->second.operands.size() ? (inst->second.operands[idx].bits + 7u) / 8u : 0u;
+                  };
+
+                  /* Write length rows then width rows, unused opcodes have length 0. */
+                  out.append(lengths_head);
+                  this->walk_opcodes(entries, [&](const auto &inst, const bool used, const bool last) {
+                        std::size_t length = opbytes;
+                        for (auto idx = 0u; idx < slots; ++idx) {
+                              length += width(inst, used, idx);
+                        }
+                        out.append("   ").append(std::to_string(used ? length : 0u)).append(!last ? "," : "");
+                        if (used) {
+                              out.append(" /* ").append(this->str(inst->second.mnemonic)).append(" */");
+                        }
+                        out.append("\n");
+                  });
+                  out.append(widths_head);
+                  this->walk_opcodes(entries, [&](const auto &inst, const bool used, const bool last) {
+                        out.append("   {");
+                        for (auto idx = 0u; idx < slots; ++idx) {
+                              out.append(std::to_string(width(inst, used, idx))).append(idx != slots - 1u ? ", " : "");
+                        }
+                        out.append("}").append(!last ? "," : "");
+                        if (used) {
+                              out.append(" /* ").append(this->str(inst->second.mnemonic)).append(" */");
+                        }
+                        out.append("\n");
+                  });
+                  out.append(definition).append(retn).append(footer);
+
+                  return;
+            }
+
+            /* Create structure of arrays bulk decoder for fixed width instruction sets, uses AVX2 when the cpu has it. */
+            template <language lang = language::cpp>
+            std::string represent_bulk_decoder() {
+                  std::string retn = "";
+                  sink out = create_sink(retn);
+                  this->represent_bulk_decoder<lang>(out);
+                  out.flush();
+                  return retn;
+            }
+
+            /* Stream structure of arrays bulk decoder, table rows are written as they are created. */
+            template <language lang = language::cpp>
+            void represent_bulk_decoder(sink &out) {
+
+                  ISCREATE_PHASE(this->statistics[phase::bulk_decoder], &out);
+
+                  std::string definition = "";
+                  std::string footer = "";
+                  std::string retn = "";
+
+                  /* Nothing */
+                  if (this->instructions.empty()) {
+                        return;
+                  }
+
+                  /* Opcodes index the decode tables directly. */
+                  const auto high = this->instructions.back().first;
+                  if (this->instructions.front().first < 0 || high > 0xFFFF) {
+                        std::cerr << "Bulk decoder requires opcodes between 0 and 0xFFFF." << std::endl;
+                        return;
+                  }
+
+                  const std::size_t opbytes = high > 0xFF ? 2u : 1u;
+                  const std::size_t entries = opbytes == 1u ? 0x100u : static_cast<std::size_t>(high) + 1u;
+
+                  /* Every instruction must have the same width and operands must fit a 32 bit lane. */
+                  std::size_t slots = 1u;
+                  std::size_t width = 0u;
+                  std::size_t reach = 4u;
+                  for (const auto &inst : this->instructions) {
+                        std::size_t length = opbytes;
+                        for (const auto &op : inst.second.operands) {
+                              const auto bytes = (op.bits + 7u) / 8u;
+                              if (bytes > 4u) {
+                                    std::cerr << "Bulk decoder requires operands of at most 32 bits." << std::endl;
+                                    return;
+                              }
+                              reach = std::max(reach, length + 4u);
+                              length += bytes;
+                        }
+                        if (width != 0u && width != length) {
+                              std::cerr << "Bulk decoder requires every instruction to have the same width." << std::endl;
+                              return;
+                        }
+                        width = length;
+                        slots = std::max(slots, inst.second.operands.size());
+                  }
+
+                  const auto w = std::to_string(width);
+                  const auto count = std::to_string(entries);
+                  const auto slot_count = std::to_string(slots);
+                  const std::string opmask = opbytes == 1u ? "0xFF" : "0xFFFF";
+                  const std::string fetch = opbytes == 1u ? "p[0]" : "p[0] | (p[1] << 8u)";
+
+                  std::string stride = "";
+                  for (auto lane = 0u; lane < 8u; ++lane) {
+                        stride += std::to_string(lane * width) + (lane != 7u ? ", " : "");
+                  }
+
+                  /* Language specific spellings */
+                  std::string u8 = "";
+                  std::string u32 = "";
+                  std::string size = "";
+                  std::string param = "";
+                  std::string member = "";
+                  std::string table = "";
+                  std::string ints = "";
+                  std::string vec = "";
+                  std::string atomics = "";
+                  std::string detect = "";
+                  switch (lang) {
+                        case language::cpp: {
+                              u8 = "std::uint8_t";
+                              u32 = "std::uint32_t";
+                              size = "std::size_t";
+                              param = "bulk_decoded &out";
+                              member = "out.";
+                              table = "static constexpr";
+                              ints = "reinterpret_cast<const int *>(";
+                              vec = "reinterpret_cast<__m256i *>(";
+                              detect = "   static const bool avx2 = bulk_has_avx2();\n\
+   if (avx2) {\n\
+      n = bulk_decode_avx2(code, size, out, count);\n\
+   }\n";
+                              definition = "struct bulk_decoded {\n\
+   std::uint32_t *op;\n\
+   std::uint32_t *operands[" + slot_count + "];\n\
+};\n";
+                              break;
+                        }
+                        case language::c: {
+                              u8 = "uint8_t";
+                              u32 = "uint32_t";
+                              size = "size_t";
+                              param = "bulk_decoded *out";
+                              member = "out->";
+                              table = "static const";
+                              ints = "(const int *)(";
+                              vec = "(__m256i *)(";
+                              /* C has no thread safe local statics, the cached result is a relaxed atomic where C11 atomics exist. */
+                              atomics = "#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)\n\
+#define BULK_DECODE_ATOMIC 1\n\
+#include <stdatomic.h>\n\
+#endif\n";
+                              detect = "#if defined(BULK_DECODE_ATOMIC)\n\
+   static atomic_int avx2 = -1;\n\
+   int has = atomic_load_explicit(&avx2, memory_order_relaxed);\n\
+   if (has < 0) {\n\
+      has = bulk_has_avx2();\n\
+      atomic_store_explicit(&avx2, has, memory_order_relaxed);\n\
+   }\n\
+#else\n\
+   const int has = bulk_has_avx2();\n\
+#endif\n\
+   if (has) {\n\
+      n = bulk_decode_avx2(code, size, out, count);\n\
+   }\n";
+                              definition = "typedef struct {\n\
+   uint32_t *op;\n\
+   uint32_t *operands[" + slot_count + "];\n\
+} bulk_decoded;\n";
+                              break;
+                        }
+                        default: {
+                              break;
+                        }
+                  }
+
+                  /* Create scalar path */
+                  retn += "static inline " + size + " bulk_decode_scalar(const " + u8 + " *code, " + size + " size, " + param + ", " + size + " n, " + size + " count) {\n\
+   for (; n < count && (n + 1u) * " + w + "u <= size; ++n) {\n\
+      const " + u8 + " *p = code + n * " + w + "u;\n\
+      const " + u32 + " op = " + fetch + ";\n\
+      if (op >= " + count + "u || !bulk_valid[op]) {\n\
+         break;\n\
+      }\n\
+      " + member + "op[n] = op;\n\
+      for (" + size + " k = 0u; k < " + slot_count + "u; ++k) {\n\
+         const " + u32 + " mask = bulk_masks[op * " + slot_count + "u + k];\n\
+         const " + u8 + " *field = p + bulk_offsets[op * " + slot_count + "u + k];\n\
+         " + u32 + " value = 0u;\n\
+         for (" + size + " b = 0u; b < 4u && (mask >> (8u * b)) != 0u; ++b) {\n\
+            value |= (" + u32 + ")field[b] << (8u * b);\n\
+         }\n\
+         " + member + "operands[k][n] = value;\n\
+      }\n\
+   }\n\
+   return n;\n\
+}\n";
+
+                  /* Create AVX2 path, 8 instructions per iteration with gathers reading 4 bytes. */
+                  retn += "#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)\n\
+#define BULK_DECODE_X86 1\n\
+#include <immintrin.h>\n\
+#if defined(_MSC_VER)\n\
+#include <intrin.h>\n\
+#endif\n" + atomics + "\
+static inline int bulk_has_avx2(void) {\n\
+#if defined(__GNUC__) || defined(__clang__)\n\
+   return __builtin_cpu_supports(\"avx2\") ? 1 : 0;\n\
+#else\n\
+   int info[4];\n\
+   __cpuid(info, 1);\n\
+   if (!(info[2] & (1 << 27))) {\n\
+      return 0;\n\
+   }\n\
+   __cpuidex(info, 7, 0);\n\
+   return (info[1] & (1 << 5)) && (_xgetbv(0) & 6u) == 6u ? 1 : 0;\n\
+#endif\n\
+}\n\
+#if defined(__GNUC__) || defined(__clang__)\n\
+__attribute__((target(\"avx2\")))\n\
+#endif\n\
+static inline " + size + " bulk_decode_avx2(const " + u8 + " *code, " + size + " size, " + param + ", " + size + " count) {\n\
+   const __m256i stride = _mm256_setr_epi32(" + stride + ");\n\
+   const __m256i entries = _mm256_set1_epi32(" + count + ");\n\
+   const __m256i slots = _mm256_set1_epi32(" + slot_count + ");\n\
+   const __m256i opmask = _mm256_set1_epi32(" + opmask + ");\n\
+   " + size + " n = 0u;\n\
+   for (; n + 8u <= count && (n + 7u) * " + w + "u + " + std::to_string(reach) + "u <= size; n += 8u) {\n\
+      const int *base = " + ints + "code + n * " + w + "u);\n\
+      const __m256i op = _mm256_and_si256(_mm256_i32gather_epi32(base, stride, 1), opmask);\n\
+      const __m256i range = _mm256_cmpgt_epi32(entries, op);\n\
+      const __m256i row = _mm256_and_si256(op, range);\n\
+      const __m256i valid = _mm256_and_si256(_mm256_i32gather_epi32(" + ints + "bulk_valid), row, 4), range);\n\
+      if (_mm256_movemask_epi8(valid) != -1) {\n\
+         break;\n\
+      }\n\
+      _mm256_storeu_si256(" + vec + member + "op + n), op);\n\
+      const __m256i first = _mm256_mullo_epi32(row, slots);\n\
+      for (int k = 0; k < " + slot_count + "; ++k) {\n\
+         const __m256i field = _mm256_add_epi32(first, _mm256_set1_epi32(k));\n\
+         const __m256i offset = _mm256_add_epi32(stride, _mm256_i32gather_epi32(" + ints + "bulk_offsets), field, 4));\n\
+         const __m256i mask = _mm256_i32gather_epi32(" + ints + "bulk_masks), field, 4);\n\
+         _mm256_storeu_si256(" + vec + member + "operands[k] + n), _mm256_and_si256(_mm256_i32gather_epi32(base, offset, 1), mask));\n\
+      }\n\
+   }\n\
+   return n;\n\
+}\n\
+#endif\n";
+
+                  /* Create dispatch */
+                  retn += "/* Decode up to count " + w + " byte instructions into columns, stops early on an unknown opcode. */\n\
+static inline " + size + " bulk_decode(const " + u8 + " *code, " + size + " size, " + param + ", " + size + " count) {\n\
+   " + size + " n = 0u;\n\
+#if defined(BULK_DECODE_X86)\n" + detect + "#endif\n\
+   return bulk_decode_scalar(code, size, out, n, count);\n";
+
+                  /* Create footer */
+                  switch (lang) {
+                        case language::c:
+                        case language::cpp: {
+                              footer = "}";
+                              break;
+                        }
+                        default: {
+                              break;
+                        }
+                  }
+
+                  /* Width of operand idx, 0 past the operand list or for unused opcodes. */
+                  const auto bytes = [&](const auto &inst, const bool used, const std::size_t idx) -> std::size_t {
+                        return used && idx < inst->second.operands.size() ? (inst->second.operands[idx].bits + 7u) / 8u : 0u;
+                  };
+                  const auto hint = [&](const auto &inst, const bool used, const bool last) {
+                        out.append(!last ? "," : "");
+                        if (used) {
+                              out.append(" /* ").append(this->str(inst->second.mnemonic)).append(" */");
+                        }
+                        out.append("\n");
+                  };
+
+                  /* Write validity, operand offset and operand mask tables */
+                  out.append(definition);
+                  out.append(table).append(" ").append(u32).append(" bulk_valid[").append(count).append("] = {\n");
+                  this->walk_opcodes(entries, [&](const auto &inst, const bool used, const bool last) {
+                        out.append(used ? "   0xffffffff" : "   0x0");
+                        hint(inst, used, last);
+                  });
+                  out.append("};\n").append(table).append(" ").append(u32).append(" bulk_offsets[").append(count).append(" * ").append(slot_count).append("] = {\n");
+                  this->walk_opcodes(entries, [&](const auto &inst, const bool used, const bool last) {
+                        std::size_t offset = opbytes;
+                        out.append("   ");
+                        for (auto idx = 0u; idx < slots; ++idx) {
+                              const auto n = bytes(inst, used, idx);
+                              out.append(std::to_string(n != 0u ? offset : 0u)).append(idx != slots - 1u ? ", " : "");
+                              offset += n;
+                        }
+                        hint(inst, used, last);
+                  });
+                  out.append("};\n").append(table).append(" ").append(u32).append(" bulk_masks[").append(count).append(" * ").append(slot_count).append("] = {\n");
+                  this->walk_opcodes(entries, [&](const auto &inst, const bool used, const bool last) {
+                        out.append("   ");
+                        for (auto idx = 0u; idx < slots; ++idx) {
+                              const auto n = bytes(inst, used, idx);
+                              auto mask = n != 0u ? 0xFFFFFFFFu >> (32u - 8u * n) : 0u;
+                              char digits[8];
+                              auto length = 0u;
+                              do {
+                                    digits[length++] = "0123456789abcdef"[mask & 0xFu];
+                                    mask >>= 4u;
+                              } while (mask != 0u);
+                              out.append("0x");
+                              while (length != 0u) {
+                                    out.append(&digits[--length], 1u);
+                              }
+                              out.append(idx != slots - 1u ? ", " : "");
+                        }
+                        hint(inst, used, last);
+                  });
+                  out.append("};\n").append(retn).append(footer);
+
+                  return;
+            }
 
 #pragma endregion
 
-#pragma region represent
+#pragma region lookup
 
-#pragma region enums
+            /* Create minimal perfect hash lookup from mnemonic to opcode, the first opcode of a repeated mnemonic wins. */
+            template <language lang = language::cpp>
+            std::string represent_mnemonic_lookup() {
+                  std::string retn = "";
+                  sink out = create_sink(retn);
+                  this->represent_mnemonic_lookup<lang>(out);
+                  out.flush();
+                  return retn;
+            }
 
-            /* Create opcode enum */
+            /* Stream minimal perfect hash lookup from mnemonic to opcode, one probe and one string compare per lookup. */
             template <language lang = language::cpp>
-            std::string represent_enum_opcodes() {
+            void represent_mnemonic_lookup(sink &out) {
 
-                  std::string definition = "";
-                  std::string footer = "";
-                  std::string retn = "";
+                  ISCREATE_PHASE(this->statistics[phase::mnemonic_lookup], &out);
 
                   /* Nothing */
                   if (this->instructions.empty()) {
-                        return retn;
+                        return;
                   }
 
-                  /* See if every entry increases by 1. */
-                  bool set = true;
-                  std::size_t next = 0u;
-                  if (next >= 0u) {
-                        for (const auto &i : this->instructions) {
-                              if (next++ != i.first) {
-                                    set = false;
-                                    break;
-                              }
+                  /* Distinct mnemonics, equal strings share a symbol. */
+                  std::vector<std::size_t> keys;
+                  std::vector<bool> seen(this->symbols.size(), false);
+                  for (std::size_t idx = 0u; idx < this->instructions.size(); ++idx) {
+                        const auto mnemonic = this->instructions.at(idx).second.mnemonic;
+                        if (!seen[mnemonic]) {
+                              seen[mnemonic] = true;
+                              keys.emplace_back(idx);
                         }
-                  } else {
-                        next = false;
                   }
 
-                  /* Create definition */
-                  switch (lang) {
-                        case language::cpp: {
-                              definition = "enum class " + this->opcodes_enum_name + " {\n";
+                  /* Hash and displace: keys go to buckets by seed 0, each bucket then gets a seed that sends its keys to free slots. */
+                  const auto n = static_cast<std::uint32_t>(keys.size());
+                  const auto r = n;
+                  std::vector<std::vector<std::uint32_t>> buckets(r);
+                  for (std::uint32_t key = 0u; key < n; ++key) {
+                        buckets[mnemonic_hash(this->str(this->instructions.at(keys[key]).second.mnemonic), 0u) % r].emplace_back(key);
+                  }
+
+                  /* Biggest buckets first while the table is still empty */
+                  std::vector<std::uint32_t> order(r);
+                  for (std::uint32_t idx = 0u; idx < r; ++idx) {
+                        order[idx] = idx;
+                  }
+                  std::stable_sort(order.begin(), order.end(), [&](const std::uint32_t a, const std::uint32_t b) {
+                        return buckets[a].size() > buckets[b].size();
+                  });
+
+                  constexpr std::uint32_t none = 0xFFFFFFFFu;
+                  std::vector<std::uint32_t> seeds(r, 0u);
+                  std::vector<std::uint32_t> slots(n, none);
+                  std::vector<std::uint32_t> placed;
+                  for (const auto bucket : order) {
+                        const auto &members = buckets[bucket];
+                        if (members.empty()) {
                               break;
                         }
-                        case language::c: {
-                              definition = "typedef enum {\n";
-                              break;
+                        auto seed = 1u;
+                        for (;; ++seed) {
+                              if (seed == 0x1000000u) {
+                                    std::cerr << "Mnemonic lookup found no perfect hash." << std::endl;
+                                    return;
+                              }
+                              placed.clear();
+                              for (const auto key : members) {
+                                    const auto slot = mnemonic_hash(this->str(this->instructions.at(keys[key]).second.mnemonic), seed) % n;
+                                    if (slots[slot] != none || std::find(placed.begin(), placed.end(), slot) != placed.end()) {
+                                          break;
+                                    }
+                                    placed.emplace_back(slot);
+                              }
+                              if (placed.size() == members.size()) {
+                                    break;
+                              }
                         }
-                        default: {
-                              break;
+                        seeds[bucket] = seed;
+                        for (std::size_t idx = 0u; idx < members.size(); ++idx) {
+                              slots[placed[idx]] = members[idx];
                         }
                   }
 
-                  /* Create footer */
+                  std::size_t longest = 0u;
+                  for (const auto idx : keys) {
+                        longest = std::max(longest, this->str(this->instructions.at(idx).second.mnemonic).size());
+                  }
+
+                  /* Language specific spellings */
+                  const std::string cpp_length = longest > 0xFFFFu ? "std::uint32_t" : (longest > 0xFFu ? "std::uint16_t" : "std::uint8_t");
+                  std::string u8 = "";
+                  std::string u32 = "";
+                  std::string size = "";
+                  std::string length = "";
+                  std::string table = "";
+                  std::string op = "";
+                  std::string found = "";
                   switch (lang) {
                         case language::cpp: {
-                              footer = "};";
+                              u8 = "std::uint8_t";
+                              u32 = "std::uint32_t";
+                              size = "std::size_t";
+                              length = cpp_length;
+                              table = "static constexpr";
+                              op = this->opcodes_enum_name + " &op";
+                              found = "bool";
                               break;
                         }
                         case language::c: {
-                              footer = "} " + this->opcodes_enum_name + ";";
+                              u8 = "uint8_t";
+                              u32 = "uint32_t";
+                              size = "size_t";
+                              length = cpp_length.substr(5u);
+                              table = "static const";
+                              op = this->opcodes_enum_name + " *op";
+                              found = "int";
                               break;
                         }
                         default: {
                               break;
                         }
                   }
+                  const auto count = std::to_string(n);
 
-                  for (const auto &inst : this->instructions) {
+                  /* Create tables */
+                  out.append(table).append(" ").append(u32).append(" mnemonic_seeds[").append(count).append("] = {\n");
+                  for (std::uint32_t idx = 0u; idx < r; ++idx) {
+                        out.append(idx % 16u == 0u ? "   " : "").append(std::to_string(seeds[idx])).append(idx != r - 1u ? (idx % 16u == 15u ? ",\n" : ", ") : "\n");
+                  }
+                  out.append("};\n").append(table).append(lang == language::cpp ? " const char *const" : " char *const").append(" mnemonic_names[").append(count).append("] = {\n");
+                  for (std::uint32_t slot = 0u; slot < n; ++slot) {
+                        out.append("   \"").append(this->str(this->instructions.at(keys[slots[slot]]).second.mnemonic)).append(slot != n - 1u ? "\",\n" : "\"\n");
+                  }
+                  out.append("};\n").append(table).append(" ").append(length).append(" mnemonic_lengths[").append(count).append("] = {\n");
+                  for (std::uint32_t slot = 0u; slot < n; ++slot) {
+                        out.append("   ").append(std::to_string(this->str(this->instructions.at(keys[slots[slot]]).second.mnemonic).size())).append(slot != n - 1u ? ",\n" : "\n");
+                  }
+                  out.append("};\n").append(table).append(" ").append(this->opcodes_enum_name).append(" mnemonic_opcodes[").append(count).append("] = {\n");
+                  for (std::uint32_t slot = 0u; slot < n; ++slot) {
+                        const auto &mnemonic = this->str(this->instructions.at(keys[slots[slot]]).second.mnemonic);
+                        out.append(lang == language::cpp ? "   " + this->opcodes_enum_name + "::" : "   ");
+                        this->append_enumerator(out, mnemonic).append(slot != n - 1u ? ",\n" : "\n");
+                  }
+                  out.append("};\n");
 
-                        const auto last = inst.first == this->instructions.rbegin()->first;
+                  /* Create hash, must match mnemonic_hash */
+                  out.append("static inline ").append(u32).append(" mnemonic_hash(const char *str, ").append(size).append(" length, ").append(u32).append(" seed) {\n\
+   " + u32 + " hash = 2166136261u ^ seed;\n\
+   for (" + size + " idx = 0u; idx < length; ++idx) {\n\
+      hash = (hash ^ (" + u8 + ")str[idx]) * 16777619u;\n\
+   }\n\
+   hash ^= hash >> 16u;\n\
+   hash *= 0x85ebca6bu;\n\
+   hash ^= hash >> 13u;\n\
+   return hash;\n\
+}\n");
 
-                        /* Create hint */
-                        std::stringstream stream;
-                        stream << std::hex << inst.first;
-                        std::string hex = stream.str();
+                  /* Create lookup, the compare only branches on the loop bound. */
+                  out.append("/* Find the opcode of mnemonic, op is only meaningful when it is found. */\n\
+static inline " + found + " lookup_mnemonic(const char *str, " + size + " length, " + op + ") {\n\
+   const " + u32 + " slot = mnemonic_hash(str, length, mnemonic_seeds[mnemonic_hash(str, length, 0u) % " + count + "u]) % " + count + "u;\n\
+   const char *name = mnemonic_names[slot];\n\
+   const " + size + " n = mnemonic_lengths[slot];\n\
+   " + u32 + " diff = (" + u32 + ")(n != length);\n\
+   for (" + size + " idx = 0u; idx < n && idx < length; ++idx) {\n\
+      diff |= (" + u32 + ")(" + u8 + ")(name[idx] ^ str[idx]);\n\
+   }\n\
+   " + (lang == language::cpp ? "op" : "*op") + " = mnemonic_opcodes[slot];\n\
+   return diff == 0u;\n\
+}");
 
-                        auto hint = "(" + hex + ")"; /* Opcode */
-                        if (!inst.second.hint.empty()) {
-                              hint += " | " + inst.second.hint;
-                        } /* Hint */
-                        if (!inst.second.operands.empty()) {
-                              hint += " | ";
-                        } /* Operands */
-                        for (auto idx = 0u; idx < inst.second.operands.size(); ++idx) {
-                              const auto i = inst.second.operands[idx];
-                              hint += "* " + i.operand_ + "(" + i.size + ")" + (idx != inst.second.operands.size() - 1u ? ", " : "");
-                        }
+                  return;
+            }
 
-                        /* Capatalize */
-                        auto name = "   OP_" + inst.second.mnemonic;
-                        std::transform(name.begin(), name.end(), name.begin(), std::toupper);
+#pragma endregion
 
-                        /* Create enum */
-                        switch (lang) {
-                              case language::c:
-                              case language::cpp: {
-                                    if (set) {
-                                          retn += name + (!last ? "," : "");
-                                    } else {
-                                          retn += name + " = " + std::to_string(inst.first) + (!last ? "," : "");
-                                    }
-                                    retn += " /* " + hint + " */\n";
-                                    break;
-                              }
-                              default: {
-                                    break;
-                              }
-                        }
-                  }
+#pragma region packed
 
-                  return definition + retn + footer;
+            /* Create opcode indexed table of fixed size records, each operand packs its encoding, kind and width into one word. */
+            template <language lang = language::cpp>
+            std::string represent_packed_operands() {
+                  std::string retn = "";
+                  sink out = create_sink(retn);
+                  this->represent_packed_operands<lang>(out);
+                  out.flush();
+                  return retn;
             }
 
-            /* Create operand encoding enum */
+            /* Stream packed operand table, rows are written as they are created. */
             template <language lang = language::cpp>
-            std::string represent_enum_opencodings() {
+            void represent_packed_operands(sink &out) {
 
-                  std::string definition = "";
-                  std::string footer = "";
-                  std::string retn = "";
-                  std::vector<std::string> analyzed;
+                  ISCREATE_PHASE(this->statistics[phase::packed_operands], &out);
 
                   /* Nothing */
                   if (this->instructions.empty()) {
-                        return retn;
+                        return;
+                  }
+
+                  /* Opcodes index the table directly. */
+                  const auto high = this->instructions.back().first;
+                  if (this->instructions.front().first < 0 || high > 0xFFFF) {
+                        std::cerr << "Packed operands require opcodes between 0 and 0xFFFF." << std::endl;
+                        return;
+                  }
+                  const auto entries = static_cast<std::size_t>(high) + 1u;
+
+                  /* Field values are enum positions, the enums list values in first use order. */
+                  std::vector<std::uint32_t> position(this->symbols.size(), 0u);
+                  for (std::size_t idx = 0u; idx < this->encodings.size(); ++idx) {
+                        position[this->encodings[idx]] = static_cast<std::uint32_t>(idx);
                   }
+                  std::vector<std::uint32_t> kind_position(this->symbols.size(), 0u);
+                  for (std::size_t idx = 0u; idx < this->kinds.size(); ++idx) {
+                        kind_position[this->kinds[idx]] = static_cast<std::uint32_t>(idx);
+                  }
+
+                  /* Smallest fields that hold every value */
+                  const auto field = [](std::size_t largest) {
+                        std::uint32_t bits = 1u;
+                        while (largest >> bits != 0u) {
+                              ++bits;
+                        }
+                        return bits;
+                  };
+                  std::size_t slots = 1u;
+                  std::size_t widest = 0u;
+                  for (const auto &inst : this->instructions) {
+                        slots = std::max(slots, inst.second.operands.size());
+                        for (const auto &op : inst.second.operands) {
+                              widest = std::max<std::size_t>(widest, op.bits);
+                        }
+                  }
+                  const auto width_bits = field(widest);
+                  const auto kind_bits = field(this->kinds.empty() ? 0u : this->kinds.size() - 1u);
+                  const auto encoding_bits = field(this->encodings.empty() ? 0u : this->encodings.size() - 1u);
+                  const auto total = width_bits + kind_bits + encoding_bits;
+                  if (total > 32u) {
+                        std::cerr << "Packed operands need more than 32 bits per operand." << std::endl;
+                        return;
+                  }
+                  if (slots > 0xFFu) {
+                        std::cerr << "Packed operands allow at most 255 operands per instruction." << std::endl;
+                        return;
+                  }
+                  const auto kind_shift = width_bits;
+                  const auto encoding_shift = width_bits + kind_bits;
+
+                  /* Language specific spellings */
+                  const std::string word = total > 16u ? "uint32_t" : "uint16_t";
+                  const auto slot_count = std::to_string(slots);
+                  const auto count = std::to_string(entries);
+                  const auto mask = [](const std::uint32_t bits) {
+                        auto value = bits == 32u ? 0xFFFFFFFFu : (1u << bits) - 1u;
+                        std::string hex = "";
+                        do {
+                              hex += "0123456789abcdef"[value & 0xFu];
+                              value >>= 4u;
+                        } while (value != 0u);
+                        std::reverse(hex.begin(), hex.end());
+                        return "0x" + hex + "u";
+                  };
+                  const auto layout = "/* Operand word, width in bits [0, " + std::to_string(kind_shift) + "), kind [" + std::to_string(kind_shift) + ", " + std::to_string(encoding_shift) + "), encoding [" + std::to_string(encoding_shift) + ", " + std::to_string(total) + "). */\n";
 
                   /* Create definition */
                   switch (lang) {
                         case language::cpp: {
-                              definition = "enum class " + this->opencodings_enum_name + " {\n";
+                              out.append(layout).append("typedef std::" + word + " packed_operand;\n\
+struct packed_instruction {\n\
+   packed_operand operands[" + slot_count + "];\n\
+   std::uint8_t count;\n\
+};\n\
+alignas(64) static constexpr packed_instruction packed_instructions[" + count + "] = {\n");
                               break;
                         }
                         case language::c: {
-                              definition = "typedef enum {\n";
+                              out.append(layout).append("typedef " + word + " packed_operand;\n\
+typedef struct {\n\
+   packed_operand operands[" + slot_count + "];\n\
+   uint8_t count;\n\
+} packed_instruction;\n\
+static const _Alignas(64) packed_instruction packed_instructions[" + count + "] = {\n");
                               break;
                         }
                         default: {
@@ -233,14 +2542,50 @@ namespace iscreate {
                         }
                   }
 
-                  /* Create footer */
+                  /* Create rows, unused opcodes have no operands. */
+                  this->walk_opcodes(entries, [&](const auto &inst, const bool used, const bool last) {
+                        out.append("   {{");
+                        for (std::size_t idx = 0u; idx < slots; ++idx) {
+                              std::uint32_t packed = 0u;
+                              if (used && idx < inst->second.operands.size()) {
+                                    const auto &op = inst->second.operands[idx];
+                                    packed = op.bits | (kind_position[op.kind] << kind_shift) | (position[op.encoding] << encoding_shift);
+                              }
+                              out.append(std::to_string(packed)).append(idx != slots - 1u ? ", " : "");
+                        }
+                        out.append("}, ").append(std::to_string(used ? inst->second.operands.size() : 0u)).append(!last ? "}," : "}");
+                        if (used) {
+                              out.append(" /* ").append(this->str(inst->second.mnemonic)).append(" */");
+                        }
+                        out.append("\n");
+                  });
+
+                  /* Create accessors */
                   switch (lang) {
                         case language::cpp: {
-                              footer = "};";
+                              out.append("};\n\
+static constexpr std::uint32_t packed_width(packed_operand op) {\n\
+   return op & " + mask(width_bits) + ";\n\
+}\n\
+static constexpr " + this->opkinds_enum_name + " packed_kind(packed_operand op) {\n\
+   return static_cast<" + this->opkinds_enum_name + ">((op >> " + std::to_string(kind_shift) + "u) & " + mask(kind_bits) + ");\n\
+}\n\
+static constexpr " + this->opencodings_enum_name + " packed_encoding(packed_operand op) {\n\
+   return static_cast<" + this->opencodings_enum_name + ">((op >> " + std::to_string(encoding_shift) + "u) & " + mask(encoding_bits) + ");\n\
+}");
                               break;
                         }
                         case language::c: {
-                              footer = "} " + this->opencodings_enum_name + ";";
+                              out.append("};\n\
+static inline uint32_t packed_width(packed_operand op) {\n\
+   return op & " + mask(width_bits) + ";\n\
+}\n\
+static inline " + this->opkinds_enum_name + " packed_kind(packed_operand op) {\n\
+   return (" + this->opkinds_enum_name + ")((op >> " + std::to_string(kind_shift) + "u) & " + mask(kind_bits) + ");\n\
+}\n\
+static inline " + this->opencodings_enum_name + " packed_encoding(packed_operand op) {\n\
+   return (" + this->opencodings_enum_name + ")((op >> " + std::to_string(encoding_shift) + "u) & " + mask(encoding_bits) + ");\n\
+}");
                               break;
                         }
                         default: {
@@ -248,262 +2593,554 @@ namespace iscreate {
                         }
                   }
 
-                  /* Add all operand encodings to pending analysis */
-                  for (const auto &inst : this->instructions)
-                        for (const auto &op : inst.second.operands)
-                              if (std::find(analyzed.begin(), analyzed.end(), op.encoding) == analyzed.end()) {
-                                    analyzed.emplace_back(op.encoding);
-                              }
-
-                  for (const auto &enc : analyzed) {
+                  return;
+            }
 
-                        const auto last = enc == analyzed.back();
+#pragma endregion
 
-                        /* Create enum */
-                        switch (lang) {
-                              case language::c:
-                              case language::cpp: {
-                                    retn += "   " + enc + (!last ? ",\n" : "\n");
-                                    break;
-                              }
-                              default: {
-                                    break;
-                              }
-                        }
-                  }
+#pragma region encoder
 
-                  return definition + retn + footer;
+            /* Create encoders, one function per instruction plus a batch encoder, in the format represent_decoder reads. */
+            template <language lang = language::cpp>
+            std::string represent_encoder() {
+                  std::string retn = "";
+                  sink out = create_sink(retn);
+                  this->represent_encoder<lang>(out);
+                  out.flush();
+                  return retn;
             }
 
-            /* Create operand kind enum */
+            /* Stream encoders, functions are written as they are created. */
             template <language lang = language::cpp>
-            std::string represent_enum_opkinds() {
+            void represent_encoder(sink &out) {
 
-                  std::string definition = "";
-                  std::string footer = "";
-                  std::string retn = "";
-                  std::vector<std::string> analyzed;
+                  ISCREATE_PHASE(this->statistics[phase::encoder], &out);
 
                   /* Nothing */
                   if (this->instructions.empty()) {
-                        return retn;
+                        return;
                   }
 
-                  /* Create definition */
+                  /* Opcodes index the encode tables directly. */
+                  const auto high = this->instructions.back().first;
+                  if (this->instructions.front().first < 0 || high > 0xFFFF) {
+                        std::cerr << "Encoder requires opcodes between 0 and 0xFFFF." << std::endl;
+                        return;
+                  }
+
+                  const std::size_t opbytes = high > 0xFF ? 2u : 1u;
+                  const std::size_t entries = static_cast<std::size_t>(high) + 1u;
+
+                  /* Widest operand list, operands must fit a 64 bit parameter. */
+                  std::size_t slots = 1u;
+                  for (const auto &inst : this->instructions) {
+                        for (const auto &op : inst.second.operands) {
+                              if (op.bits > 64u) {
+                                    std::cerr << "Encoder requires operands of at most 64 bits." << std::endl;
+                                    return;
+                              }
+                        }
+                        slots = std::max(slots, inst.second.operands.size());
+                  }
+
+                  /* Language specific spellings */
+                  std::string u8 = "";
+                  std::string u64 = "";
+                  std::string size = "";
+                  std::string table = "";
+                  std::string param = "";
+                  std::string cast = "";
                   switch (lang) {
                         case language::cpp: {
-                              definition = "enum class " + this->opkinds_enum_name + " {\n";
+                              u8 = "std::uint8_t";
+                              u64 = "std::uint64_t";
+                              size = "std::size_t";
+                              table = "static constexpr";
+                              param = "std::size_t &written";
+                              cast = "static_cast<std::uint8_t>(";
                               break;
                         }
                         case language::c: {
-                              definition = "typedef enum {\n";
+                              u8 = "uint8_t";
+                              u64 = "uint64_t";
+                              size = "size_t";
+                              table = "static const";
+                              param = "size_t *written";
+                              cast = "(uint8_t)(";
                               break;
                         }
                         default: {
                               break;
                         }
                   }
+                  const auto type = [&](const std::size_t bytes) {
+                        const std::string prefix = lang == language::cpp ? "std::" : "";
+                        return prefix + (bytes > 4u ? "uint64_t" : (bytes > 2u ? "uint32_t" : (bytes > 1u ? "uint16_t" : "uint8_t")));
+                  };
 
-                  /* Create footer */
+                  /* Create one encoder per instruction */
+                  std::vector<std::string> params;
+                  for (const auto &inst : this->instructions) {
+
+                        const auto &operands = inst.second.operands;
+                        std::size_t length = opbytes;
+                        for (const auto &op : operands) {
+                              length += (op.bits + 7u) / 8u;
+                        }
+
+                        /* Parameter names, clashes with the buffer parameters or each other get the operand position. */
+                        params.clear();
+                        for (std::size_t idx = 0u; idx < operands.size(); ++idx) {
+                              auto name = this->identifier(this->str(operands[idx].operand_));
+                              if (name == "out" || name == "size" || std::find(params.begin(), params.end(), name) != params.end()) {
+                                    name += "_" + std::to_string(idx);
+                              }
+                              params.emplace_back(name);
+                        }
+
+                        out.append("/* Encode ").append(this->str(inst.second.mnemonic)).append(", returns bytes written or 0 when it does not fit. */\n");
+                        out.append("static inline ").append(size).append(" encode_").append(this->identifier(this->str(inst.second.mnemonic))).append("(").append(u8).append(" *out, ").append(size).append(" size");
+                        for (std::size_t idx = 0u; idx < operands.size(); ++idx) {
+                              out.append(", ").append(type((operands[idx].bits + 7u) / 8u)).append(" ").append(params[idx]);
+                        }
+                        out.append(") {\n   if (size < ").append(std::to_string(length)).append("u) {\n      return 0u;\n   }\n");
+                        out.append("   out[0] = ").append(std::to_string(static_cast<std::size_t>(inst.first) & 0xFFu)).append("u;\n");
+                        if (opbytes == 2u) {
+                              out.append("   out[1] = ").append(std::to_string(static_cast<std::size_t>(inst.first) >> 8u)).append("u;\n");
+                        }
+                        std::size_t at = opbytes;
+                        for (std::size_t idx = 0u; idx < operands.size(); ++idx) {
+                              const auto bytes = (operands[idx].bits + 7u) / 8u;
+                              for (std::size_t b = 0u; b < bytes; ++b, ++at) {
+                                    out.append("   out[").append(std::to_string(at)).append("] = ").append(cast).append(params[idx]);
+                                    if (b != 0u) {
+                                          out.append(" >> ").append(std::to_string(8u * b)).append("u");
+                                    }
+                                    out.append(");\n");
+                              }
+                        }
+                        out.append("   return ").append(std::to_string(length)).append("u;\n}\n");
+                  }
+
+                  /* Create batch tables, unused opcodes have length 0. */
+                  const auto count = std::to_string(entries);
+                  const auto slot_count = std::to_string(slots);
+                  const auto hint = [&](const auto &inst, const bool used, const bool last) {
+                        out.append(!last ? "," : "");
+                        if (used) {
+                              out.append(" /* ").append(this->str(inst->second.mnemonic)).append(" */");
+                        }
+                        out.append("\n");
+                  };
                   switch (lang) {
                         case language::cpp: {
-                              footer = "};";
+                              out.append("struct encode_record {\n   " + this->opcodes_enum_name + " op;\n   std::uint64_t operands[" + slot_count + "];\n};\n");
                               break;
                         }
                         case language::c: {
-                              footer = "} " + this->opkinds_enum_name + ";";
+                              out.append("typedef struct {\n   " + this->opcodes_enum_name + " op;\n   uint64_t operands[" + slot_count + "];\n} encode_record;\n");
                               break;
                         }
                         default: {
                               break;
                         }
                   }
-
-                  /* Add all operand encodings to pending analysis */
-                  for (const auto &inst : this->instructions)
-                        for (const auto &op : inst.second.operands)
-                              if (std::find(analyzed.begin(), analyzed.end(), op.kind) == analyzed.end()) {
-                                    analyzed.emplace_back(op.kind);
-                              }
-
-                  for (const auto &k : analyzed) {
-
-                        const auto last = k == analyzed.back();
-
-                        /* Create enum */
-                        switch (lang) {
-                              case language::c:
-                              case language::cpp: {
-                                    retn += "   " + k + (!last ? ",\n" : "\n");
-                                    break;
-                              }
-                              default: {
-                                    break;
+                  out.append(table).append(" ").append(u8).append(" encode_lengths[").append(count).append("] = {\n");
+                  this->walk_opcodes(entries, [&](const auto &inst, const bool used, const bool last) {
+                        std::size_t length = opbytes;
+                        if (used) {
+                              const auto operands = inst->second.operands;
+                              for (const auto &op : operands) {
+                                    length += (op.bits + 7u) / 8u;
                               }
                         }
-                  }
+                        out.append("   ").append(std::to_string(used ? length : 0u));
+                        hint(inst, used, last);
+                  });
+                  out.append("};\n").append(table).append(" ").append(u8).append(" encode_widths[").append(count).append("][").append(slot_count).append("] = {\n");
+                  this->walk_opcodes(entries, [&](const auto &inst, const bool used, const bool last) {
+                        out.append("   {");
+                        for (std::size_t idx = 0u; idx < slots; ++idx) {
+                              const auto bytes = used && idx < inst->second.operands.size() ? (inst->second.operands[idx].bits + 7u) / 8u : 0u;
+                              out.append(std::to_string(bytes)).append(idx != slots - 1u ? ", " : "");
+                        }
+                        out.append("}");
+                        hint(inst, used, last);
+                  });
 
-                  return definition + retn + footer;
+                  /* Create batch encoder */
+                  const std::string store = opbytes == 1u ? "      p[0] = " + cast + "op);\n" : "      p[0] = " + cast + "op);\n      p[1] = " + cast + "op >> 8u);\n";
+                  out.append("};\n\
+/* Encode up to count records, stops early on an unknown opcode or a full buffer. */\n\
+static inline " + size + " encode(const encode_record *records, " + size + " count, " + u8 + " *out, " + size + " size, " + param + ") {\n\
+   " + size + " offset = 0u;\n\
+   " + size + " n = 0u;\n\
+   for (; n < count; ++n) {\n\
+      const " + size + " op = (" + size + ")records[n].op;\n\
+      const " + size + " length = op < " + count + "u ? encode_lengths[op] : 0u;\n\
+      if (length == 0u || size - offset < length) {\n\
+         break;\n\
+      }\n\
+      " + u8 + " *p = out + offset;\n" + store + "\
+      p += " + std::to_string(opbytes) + "u;\n\
+      for (" + size + " k = 0u; k < " + slot_count + "u; ++k) {\n\
+         const " + size + " width = encode_widths[op][k];\n\
+         const " + u64 + " value = records[n].operands[k];\n\
+         for (" + size + " b = 0u; b < width; ++b) {\n\
+            p[b] = " + cast + "value >> (8u * b));\n\
+         }\n\
+         p += width;\n\
+      }\n\
+      offset += length;\n\
+   }\n\
+   " + (lang == language::cpp ? "written" : "*written") + " = offset;\n\
+   return n;\n\
+}");
+
+                  return;
             }
 
 #pragma endregion
 
-#pragma region arrays
+#pragma region formatter
 
-            /* Create opcode encoding table */
+            /* Create disassembly formatter for represent_decoder output, registers print as r<decimal> and other kinds as hex. */
             template <language lang = language::cpp>
-            std::string represent_opencodings() {
-
-                  std::string definition = "";
-                  std::string footer = "";
+            std::string represent_formatter() {
                   std::string retn = "";
+                  sink out = create_sink(retn);
+                  this->represent_formatter<lang>(out);
+                  out.flush();
+                  return retn;
+            }
+
+            /* Stream disassembly formatter, table rows are written as they are created. */
+            template <language lang = language::cpp>
+            void represent_formatter(sink &out) {
+
+                  ISCREATE_PHASE(this->statistics[phase::formatter], &out);
 
                   /* Nothing */
                   if (this->instructions.empty()) {
-                        return retn;
+                        return;
                   }
 
-                  /* See if every entry increases by 1. */
-                  bool set = true;
-                  std::size_t next = 0u;
-                  if (next >= 0u) {
-                        for (const auto &i : this->instructions) {
-                              if (next++ != i.first) {
-                                    set = false;
-                                    break;
-                              }
-                        }
-                  } else {
-                        next = false;
+                  /* Same opcode range and operand slots as the decoder */
+                  const auto high = this->instructions.back().first;
+                  if (this->instructions.front().first < 0 || high > 0xFFFF) {
+                        std::cerr << "Formatter requires opcodes between 0 and 0xFFFF." << std::endl;
+                        return;
                   }
+                  const auto entries = static_cast<std::size_t>(high) + 1u;
 
-                  /* Create definition */
-                  switch (lang) {
-                        case language::cpp: {
-                              definition = "struct optable_encoding {\n\
-   " + this->opcodes_enum_name + " op;\n\
-   std::vector<operand_encoding> encodings;\n\
-};\n\
-static std::map<" + this->opcodes_enum_name + ", optable_encoding> opencodings = {\n";
-                              break;
+                  std::size_t slots = 1u;
+                  std::size_t longest = 0u;
+                  std::size_t limit = 0u;
+                  for (const auto &inst : this->instructions) {
+                        slots = std::max(slots, inst.second.operands.size());
+                        longest = std::max(longest, this->str(inst.second.mnemonic).size());
+                        for (const auto &op : inst.second.operands) {
+                              longest = std::max(longest, this->str(op.operand_).size());
                         }
-                        case language::c: {
-                              definition = "struct optable_encoding {\n\
-   " + this->opcodes_enum_name + " op;\n\
-   operand_encoding []encodings;\n\
-   size_t num_encodings;\n\
-};\n\
-static struct optable_encoding opencodings[] = {\n";
-                              break;
+                  }
+
+                  /* Styles from kind: 1 register, 2 hex */
+                  const auto style = [&](const interned_operand &op) {
+                        auto kind = this->str(op.kind);
+                        for (auto &c : kind) {
+                              c = c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
                         }
-                        default: {
-                              break;
+                        return kind.find("reg") != std::string::npos ? 1u : 2u;
+                  };
+
+                  /* Longest line of an instruction: mnemonic, then per operand separator, name, '=' and 20 digits or 0x and 16 digits, then '\n'. */
+                  const auto line = [&](const auto &inst) {
+                        std::size_t length = this->str(inst.second.mnemonic).size() + 1u;
+                        for (const auto &op : inst.second.operands) {
+                              length += 2u + this->str(op.operand_).size() + 1u + 21u;
                         }
+                        return length;
+                  };
+                  for (const auto &inst : this->instructions) {
+                        limit = std::max(limit, line(inst));
                   }
 
-                  /* Create footer */
+                  /* Language specific spellings */
+                  const std::string cpp_length = longest > 0xFFFFu ? "std::uint32_t" : (longest > 0xFFu ? "std::uint16_t" : "std::uint8_t");
+                  const std::string cpp_limit = limit > 0xFFFFu ? "std::uint32_t" : (limit > 0xFFu ? "std::uint16_t" : "std::uint8_t");
+                  std::string u8 = "";
+                  std::string u64 = "";
+                  std::string size = "";
+                  std::string length = "";
+                  std::string limits = "";
+                  std::string table = "";
+                  std::string strings = "";
+                  std::string flag = "";
+                  std::string param = "";
+                  std::string written = "";
                   switch (lang) {
                         case language::cpp: {
-                              footer = "};";
+                              u8 = "std::uint8_t";
+                              u64 = "std::uint64_t";
+                              size = "std::size_t";
+                              length = cpp_length;
+                              limits = cpp_limit;
+                              table = "static constexpr";
+                              strings = "static constexpr const char *const";
+                              flag = "bool";
+                              param = "std::size_t &written";
+                              written = "written";
                               break;
                         }
                         case language::c: {
-                              footer = "};";
+                              u8 = "uint8_t";
+                              u64 = "uint64_t";
+                              size = "size_t";
+                              length = cpp_length.substr(5u);
+                              limits = cpp_limit.substr(5u);
+                              table = "static const";
+                              strings = "static const char *const";
+                              flag = "int";
+                              param = "size_t *written";
+                              written = "*written";
                               break;
                         }
                         default: {
                               break;
                         }
                   }
+                  const auto count = std::to_string(entries);
+                  const auto slot_count = std::to_string(slots);
+                  const auto hint = [&](const auto &inst, const bool used, const bool last) {
+                        out.append(!last ? "," : "");
+                        if (used) {
+                              out.append(" /* ").append(this->str(inst->second.mnemonic)).append(" */");
+                        }
+                        out.append("\n");
+                  };
+                  const auto operand_at = [](const auto &inst, const bool used, const std::size_t idx) -> const interned_operand * {
+                        return used && idx < inst->second.operands.size() ? &inst->second.operands[idx] : nullptr;
+                  };
 
-                  for (const auto &inst : this->instructions) {
+                  /* Create tables, unused opcodes have a limit of 0. */
+                  out.append(strings).append(" format_mnemonics[").append(count).append("] = {\n");
+                  this->walk_opcodes(entries, [&](const auto &inst, const bool used, const bool last) {
+                        out.append("   \"").append(used ? this->str(inst->second.mnemonic) : std::string()).append("\"");
+                        hint(inst, used, last);
+                  });
+                  out.append("};\n").append(table).append(" ").append(length).append(" format_mnemonic_lengths[").append(count).append("] = {\n");
+                  this->walk_opcodes(entries, [&](const auto &inst, const bool used, const bool last) {
+                        out.append("   ").append(std::to_string(used ? this->str(inst->second.mnemonic).size() : 0u));
+                        hint(inst, used, last);
+                  });
+                  out.append("};\n").append(strings).append(" format_names[").append(count).append("][").append(slot_count).append("] = {\n");
+                  this->walk_opcodes(entries, [&](const auto &inst, const bool used, const bool last) {
+                        out.append("   {");
+                        for (std::size_t idx = 0u; idx < slots; ++idx) {
+                              const auto *op = operand_at(inst, used, idx);
+                              out.append("\"").append(op != nullptr ? this->str(op->operand_) : std::string()).append(idx != slots - 1u ? "\", " : "\"");
+                        }
+                        out.append("}");
+                        hint(inst, used, last);
+                  });
+                  out.append("};\n").append(table).append(" ").append(length).append(" format_name_lengths[").append(count).append("][").append(slot_count).append("] = {\n");
+                  this->walk_opcodes(entries, [&](const auto &inst, const bool used, const bool last) {
+                        out.append("   {");
+                        for (std::size_t idx = 0u; idx < slots; ++idx) {
+                              const auto *op = operand_at(inst, used, idx);
+                              out.append(std::to_string(op != nullptr ? this->str(op->operand_).size() : 0u)).append(idx != slots - 1u ? ", " : "");
+                        }
+                        out.append("}");
+                        hint(inst, used, last);
+                  });
+                  out.append("};\n/* 0 no operand, 1 register, 2 hex */\n").append(table).append(" ").append(u8).append(" format_styles[").append(count).append("][").append(slot_count).append("] = {\n");
+                  this->walk_opcodes(entries, [&](const auto &inst, const bool used, const bool last) {
+                        out.append("   {");
+                        for (std::size_t idx = 0u; idx < slots; ++idx) {
+                              const auto *op = operand_at(inst, used, idx);
+                              out.append(std::to_string(op != nullptr ? style(*op) : 0u)).append(idx != slots - 1u ? ", " : "");
+                        }
+                        out.append("}");
+                        hint(inst, used, last);
+                  });
+                  out.append("};\n").append(table).append(" ").append(limits).append(" format_limits[").append(count).append("] = {\n");
+                  this->walk_opcodes(entries, [&](const auto &inst, const bool used, const bool last) {
+                        out.append("   ").append(std::to_string(used ? line(*inst) : 0u));
+                        hint(inst, used, last);
+                  });
 
-                        const auto last = inst.first == this->instructions.rbegin()->first;
+                  /* Create digit writers and batch formatter */
+                  out.append("};\n\
+static inline " + size + " format_hex(char *p, " + u64 + " value) {\n\
+   " + size + " digits = 1u;\n\
+   while (digits < 16u && (value >> (4u * digits)) != 0u) {\n\
+      ++digits;\n\
+   }\n\
+   p[0] = '0';\n\
+   p[1] = 'x';\n\
+   for (" + size + " idx = digits; idx != 0u; --idx) {\n\
+      p[1u + idx] = \"0123456789abcdef\"[value & 0xFu];\n\
+      value >>= 4u;\n\
+   }\n\
+   return digits + 2u;\n\
+}\n\
+static inline " + size + " format_decimal(char *p, " + u64 + " value) {\n\
+   char digits[20];\n\
+   " + size + " n = 0u;\n\
+   do {\n\
+      digits[n++] = (char)('0' + value % 10u);\n\
+      value /= 10u;\n\
+   } while (value != 0u);\n\
+   for (" + size + " idx = 0u; idx < n; ++idx) {\n\
+      p[idx] = digits[n - 1u - idx];\n\
+   }\n\
+   return n;\n\
+}\n\
+/* Format up to count decoded instructions one per line, stops early when the next line might not fit. */\n\
+static inline " + size + " format(const decoded_instruction *in, " + size + " count, char *out, " + size + " size, " + flag + " names, " + param + ") {\n\
+   " + size + " offset = 0u;\n\
+   " + size + " n = 0u;\n\
+   for (; n < count; ++n) {\n\
+      const " + size + " op = (" + size + ")in[n].op;\n\
+      const " + size + " limit = op < " + count + "u ? format_limits[op] : 0u;\n\
+      if (limit == 0u || size - offset < limit) {\n\
+         break;\n\
+      }\n\
+      char *p = out + offset;\n\
+      for (" + size + " idx = 0u; idx < format_mnemonic_lengths[op]; ++idx) {\n\
+         *p++ = format_mnemonics[op][idx];\n\
+      }\n\
+      for (" + size + " k = 0u; k < " + slot_count + "u && format_styles[op][k] != 0u; ++k) {\n\
+         if (k != 0u) {\n\
+            *p++ = ',';\n\
+         }\n\
+         *p++ = ' ';\n\
+         if (names) {\n\
+            for (" + size + " idx = 0u; idx < format_name_lengths[op][k]; ++idx) {\n\
+               *p++ = format_names[op][k][idx];\n\
+            }\n\
+            *p++ = '=';\n\
+         }\n\
+         if (format_styles[op][k] == 1u) {\n\
+            *p++ = 'r';\n\
+            p += format_decimal(p, in[n].operands[k]);\n\
+         } else {\n\
+            p += format_hex(p, in[n].operands[k]);\n\
+         }\n\
+      }\n\
+      *p++ = '\\n';\n\
+      offset = (" + size + ")(p - out);\n\
+   }\n\
+   " + written + " = offset;\n\
+   return n;\n\
+}");
 
-                        /* Create hint */
-                        std::stringstream stream;
-                        stream << std::hex << inst.first;
-                        std::string hint = stream.str();
+                  return;
+            }
 
-                        /* Capatalize */
-                        auto name = "OP_" + inst.second.mnemonic;
-                        std::transform(name.begin(), name.end(), name.begin(), std::toupper);
+#pragma endregion
 
-                        /* Create enum */
-                        switch (lang) {
-                              case language::c: { /* {??, {??, {??, ??}}} 1 */
-                                    retn += "   {" + name + ", {";
-                                    for (auto idx = 0u; idx < inst.second.operands.size(); ++idx) {
-                                          const auto i = inst.second.operands[idx];
-                                          retn += i.encoding + (idx != inst.second.operands.size() - 1u ? ", " : "");
-                                    }
-                                    retn += "}, " + std::to_string(inst.second.operands.size()) + std::string(!last ? "}," : "}");
-                                    retn += " /* " + hint + " */\n";
-                                    break;
-                              }
-                              case language::cpp: { /* {opcodes::??, {opcodes::??, {operand_encoding::??, operand_encoding::??}}} 1 */
-                                    retn += "   {" + this->opcodes_enum_name + "::" + name + ", {" + this->opcodes_enum_name + "::" + name + ", {";
-                                    for (auto idx = 0u; idx < inst.second.operands.size(); ++idx) {
-                                          const auto i = inst.second.operands[idx];
-                                          retn += this->opencodings_enum_name + "::" + i.encoding + (idx != inst.second.operands.size() - 1u ? ", " : "");
-                                    }
-                                    retn += "}}}" + std::string(!last ? "," : "");
-                                    retn += " /* " + hint + " */\n";
-                                    break;
-                              }
-                              default: {
-                                    break;
-                              }
-                        }
-                  }
+#pragma region dispatch
 
-                  return definition + retn + footer;
+            /* Create nested dispatch tables for opcode_maps, a decoder walks one opcode byte per level. */
+            template <language lang = language::cpp>
+            std::string represent_dispatch() {
+                  std::string retn = "";
+                  sink out = create_sink(retn);
+                  this->represent_dispatch<lang>(out);
+                  out.flush();
+                  return retn;
             }
 
-            /* Create opcode kind table */
+            /* Stream nested dispatch tables, each level is a dense table over the bytes it uses. */
             template <language lang = language::cpp>
-            std::string represent_opkinds() {
+            void represent_dispatch(sink &out) {
 
-                  std::string definition = "";
-                  std::string footer = "";
-                  std::string retn = "";
+                  ISCREATE_PHASE(this->statistics[phase::dispatch], &out);
 
                   /* Nothing */
                   if (this->instructions.empty()) {
-                        return retn;
+                        return;
                   }
 
-                  /* See if every entry increases by 1. */
-                  bool set = true;
-                  std::size_t next = 0u;
-                  if (next >= 0u) {
-                        for (const auto &i : this->instructions) {
-                              if (next++ != i.first) {
-                                    set = false;
-                                    break;
-                              }
+                  /* Levels keyed by their prefix as a number, the root is 0. Intermediate levels of a longer prefix are implied. */
+                  std::map<std::uintptr_t, std::vector<std::uint8_t>> levels = {{0u, {}}};
+                  for (const auto &prefix : this->opcode_maps) {
+                        if (prefix.empty() || prefix.size() >= sizeof(std::intptr_t) || prefix.front() == 0u) {
+                              std::cerr << "Opcode map prefixes need 1 to " + std::to_string(sizeof(std::intptr_t) - 1u) + " bytes and a non zero first byte." << std::endl;
+                              return;
+                        }
+                        std::uintptr_t key = 0u;
+                        for (const auto byte : prefix) {
+                              key = key << 8u | byte;
+                              levels.emplace(key, std::vector<std::uint8_t>());
+                        }
+                  }
+                  for (auto &level : levels) {
+                        for (auto key = level.first; key != 0u; key >>= 8u) {
+                              level.second.insert(level.second.begin(), static_cast<std::uint8_t>(key & 0xFFu));
                         }
-                  } else {
-                        next = false;
                   }
 
-                  /* Create definition */
+                  /* Entry of every byte per level: instruction ordinal + 1, or -(level + 1) for the next level. */
+                  std::map<std::uintptr_t, std::map<std::uint8_t, std::int64_t>> entries;
+                  std::map<std::uintptr_t, std::size_t> order;
+                  std::vector<std::uintptr_t> walk = {0u};
+                  for (std::size_t idx = 0u; idx < walk.size(); ++idx) {
+                        order[walk[idx]] = idx;
+                        auto child = walk[idx] != 0u ? levels.lower_bound(walk[idx] << 8u) : levels.upper_bound(0u);
+                        for (; child != levels.end() && (child->first >> 8u) == walk[idx]; ++child) {
+                              walk.push_back(child->first);
+                        }
+                  }
+                  for (const auto &level : order) {
+                        if (level.first != 0u) {
+                              entries[level.first >> 8u][static_cast<std::uint8_t>(level.first & 0xFFu)] = -static_cast<std::int64_t>(level.second + 1u);
+                        }
+                        entries[level.first];
+                  }
+                  std::size_t ordinal = 0u;
+                  for (const auto &inst : this->instructions) {
+                        const auto key = static_cast<std::uintptr_t>(inst.first) >> 8u;
+                        if (inst.first < 0 || levels.find(key) == levels.end()) {
+                              std::cerr << "Opcode " + std::to_string(inst.first) + " is not in any opcode map." << std::endl;
+                              return;
+                        }
+                        auto &entry = entries[key][static_cast<std::uint8_t>(inst.first & 0xFF)];
+                        if (entry < 0) {
+                              std::cerr << "Opcode " + std::to_string(inst.first) + " is also an opcode map prefix." << std::endl;
+                              return;
+                        }
+                        entry = static_cast<std::int64_t>(++ordinal);
+                  }
+
+                  /* Language specific spellings */
+                  const auto wide = std::max(this->instructions.size(), walk.size()) >= 0x7FFFu;
+                  std::string entry_type = wide ? "int32_t" : "int16_t";
+                  std::string u8 = "uint8_t";
+                  std::string u16 = "uint16_t";
+                  std::string u32 = "uint32_t";
+                  std::string size = "size_t";
+                  std::string table = "static const";
+                  std::string op = this->opcodes_enum_name + " *op";
+                  std::string result = "*op";
+                  std::string scope = "";
+                  std::string head = "typedef struct {\n";
+                  std::string tail = "} dispatch_table;\n";
                   switch (lang) {
                         case language::cpp: {
-                              definition = "struct optable_kind {\n\
-   " + this->opcodes_enum_name + " op;\n\
-   std::vector<operand_kind> kinds;\n\
-};\n\
-static std::map<" + this->opcodes_enum_name + ", optable_kind> opkinds = {\n";
+                              head = "struct dispatch_table {\n";
+                              tail = "};\n";
+                              for (auto *type : {&entry_type, &u8, &u16, &u32, &size}) {
+                                    type->insert(0u, "std::");
+                              }
+                              table = "static constexpr";
+                              op = this->opcodes_enum_name + " &op";
+                              result = "op";
+                              scope = this->opcodes_enum_name + "::";
                               break;
                         }
                         case language::c: {
-                              definition = "struct optable_kind {\n\
-   " + this->opcodes_enum_name + " op;\n\
-   operand_encoding []kinds;\n\
-   size_t num_kinds;\n\
-};\n\
-static struct optable_kind opkinds[] = {\n";
                               break;
                         }
                         default: {
@@ -511,14 +3148,139 @@ static struct optable_kind opkinds[] = {\n";
                         }
                   }
 
-                  /* Create footer */
+                  /* Prefix bytes as hex for comments */
+                  const auto bytes = [](const std::vector<std::uint8_t> &prefix, const std::uint8_t last) {
+                        std::string retn = "";
+                        for (const auto byte : prefix) {
+                              retn.append(1u, "0123456789ABCDEF"[byte >> 4u]).append(1u, "0123456789ABCDEF"[byte & 0xFu]).append(" ");
+                        }
+                        return retn.append(1u, "0123456789ABCDEF"[last >> 4u]).append(1u, "0123456789ABCDEF"[last & 0xFu]);
+                  };
+
+                  /* Create level tables, each covers its lowest to highest used byte. */
+                  out.append(head).append("   ").append(u8).append(" low;\n   ").append(u16).append(" count;\n   ").append(u32).append(" first;\n").append(tail);
+                  out.append(table).append(" dispatch_table dispatch_tables[").append(std::to_string(walk.size())).append("] = {\n");
+                  std::size_t total = 0u;
+                  for (std::size_t idx = 0u; idx < walk.size(); ++idx) {
+                        const auto &used = entries[walk[idx]];
+                        const auto low = used.empty() ? 0u : used.begin()->first;
+                        const auto count = used.empty() ? 0u : used.rbegin()->first - low + 1u;
+                        out.append("   {").append(std::to_string(low)).append(", ").append(std::to_string(count)).append(", ").append(std::to_string(total)).append("}");
+                        out.append(idx != walk.size() - 1u ? "," : "").append(" /* ").append(walk[idx] == 0u ? std::string("root") : bytes(std::vector<std::uint8_t>(levels[walk[idx]].begin(), levels[walk[idx]].end() - 1), levels[walk[idx]].back())).append(" */\n");
+                        total += count;
+                  }
+
+                  /* Create entries, 0 is an unknown opcode. */
+                  std::vector<std::string> mnemonics;
+                  mnemonics.reserve(this->instructions.size());
+                  for (const auto &inst : this->instructions) {
+                        mnemonics.push_back(this->str(inst.second.mnemonic));
+                  }
+                  out.append("};\n").append(table).append(" ").append(entry_type).append(" dispatch_entries[").append(std::to_string(std::max<std::size_t>(total, 1u))).append("] = {\n");
+                  std::size_t written = 0u;
+                  for (const auto key : walk) {
+                        const auto &used = entries[key];
+                        if (used.empty()) {
+                              continue;
+                        }
+                        const auto low = used.begin()->first;
+                        const auto high = used.rbegin()->first;
+                        for (auto byte = static_cast<std::size_t>(low); byte <= high; ++byte) {
+                              const auto found = used.find(static_cast<std::uint8_t>(byte));
+                              const auto value = found != used.end() ? found->second : 0;
+                              out.append("   ").append(std::to_string(value)).append(++written != total ? "," : "");
+                              if (value != 0) {
+                                    out.append(" /* ").append(bytes(levels[key], static_cast<std::uint8_t>(byte))).append(value > 0 ? " " + mnemonics[static_cast<std::size_t>(value - 1)] : std::string(" map")).append(" */");
+                              }
+                              out.append("\n");
+                        }
+                  }
+                  if (total == 0u) {
+                        out.append("   0\n");
+                  }
+
+                  /* Create instruction ordinal to opcode table and the walk */
+                  out.append("};\n").append(table).append(" ").append(this->opcodes_enum_name).append(" dispatch_opcodes[").append(std::to_string(this->instructions.size())).append("] = {\n");
+                  for (std::size_t idx = 0u; idx < mnemonics.size(); ++idx) {
+                        this->append_enumerator(out.append("   ").append(scope), mnemonics[idx]).append(idx != mnemonics.size() - 1u ? ",\n" : "\n");
+                  }
+                  out.append("};\n\
+/* Walk opcode bytes one level at a time, returns the opcode length or 0 for an unknown or truncated opcode. */\n\
+static inline " + size + " dispatch(const " + u8 + " *code, " + size + " size, " + op + ") {\n\
+   " + size + " level = 0u;\n\
+   " + size + " offset = 0u;\n\
+   while (offset < size) {\n\
+      const dispatch_table *t = &dispatch_tables[level];\n\
+      const " + size + " idx = (" + size + ")code[offset++] - t->low;\n\
+      if (idx >= t->count) {\n\
+         return 0u;\n\
+      }\n\
+      const " + entry_type + " entry = dispatch_entries[t->first + idx];\n\
+      if (entry > 0) {\n\
+         " + result + " = dispatch_opcodes[entry - 1];\n\
+         return offset;\n\
+      }\n\
+      if (entry == 0) {\n\
+         return 0u;\n\
+      }\n\
+      level = (" + size + ")(-entry - 1);\n\
+   }\n\
+   return 0u;\n\
+}");
+
+                  return;
+            }
+
+#pragma endregion
+
+#pragma region interpreter
+
+            /* Create interpreter skeleton over represent_decoder output with computed goto, tail call and switch dispatch. */
+            template <language lang = language::cpp>
+            std::string represent_interpreter() {
+                  std::string retn = "";
+                  sink out = create_sink(retn);
+                  this->represent_interpreter<lang>(out);
+                  out.flush();
+                  return retn;
+            }
+
+            /* Stream interpreter skeleton, handler bodies come from INTERPRET_<MNEMONIC> macros defined before it. */
+            template <language lang = language::cpp>
+            void represent_interpreter(sink &out) {
+
+                  ISCREATE_PHASE(this->statistics[phase::interpreter], &out);
+
+                  /* Nothing */
+                  if (this->instructions.empty()) {
+                        return;
+                  }
+
+                  /* Handler tables are indexed by opcode like the decode tables. */
+                  const auto high = this->instructions.back().first;
+                  if (this->instructions.front().first < 0 || high > 0xFFFF) {
+                        std::cerr << "Interpreter requires opcodes between 0 and 0xFFFF." << std::endl;
+                        return;
+                  }
+                  const auto entries = static_cast<std::size_t>(high) + 1u;
+                  const auto count = std::to_string(entries);
+
+                  /* Language specific spellings */
+                  std::string u64 = "uint64_t";
+                  std::string size = "size_t";
+                  std::string scope = "";
+                  std::string null = "NULL";
+                  std::string musttail = "__attribute__((musttail))";
                   switch (lang) {
                         case language::cpp: {
-                              footer = "};";
+                              u64 = "std::uint64_t";
+                              size = "std::size_t";
+                              scope = this->opcodes_enum_name + "::";
+                              null = "nullptr";
+                              musttail = "[[clang::musttail]]";
                               break;
                         }
                         case language::c: {
-                              footer = "};";
                               break;
                         }
                         default: {
@@ -526,188 +3288,931 @@ static struct optable_kind opkinds[] = {\n";
                         }
                   }
 
+                  /* OP_ and INTERPRET_ suffix of every instruction */
+                  std::vector<std::string> names;
+                  names.reserve(this->instructions.size());
                   for (const auto &inst : this->instructions) {
+                        std::string name = "";
+                        this->append_upper(name, this->str(inst.second.mnemonic));
+                        names.push_back(std::move(name));
+                  }
 
-                        const auto last = inst.first == this->instructions.rbegin()->first;
+                  /* Handler body with one constant per operand in scope, clashes with the interpreter locals or each other get the operand position. */
+                  std::vector<std::string> locals;
+                  const auto body = [&](const auto &inst, const std::string &name, const std::string &indent) {
+                        const auto &operands = inst.second.operands;
+                        std::string retn = indent + "{\n";
+                        locals.clear();
+                        for (std::size_t idx = 0u; idx < operands.size(); ++idx) {
+                              auto local = this->identifier(this->str(operands[idx].operand_));
+                              if (local == "state" || local == "ip" || local == "next" || local == "end" || local == "code" || local == "count" || local == "executed" || local == "labels" ||
+                                  std::find(locals.begin(), locals.end(), local) != locals.end()) {
+                                    local += "_" + std::to_string(idx);
+                              }
+                              retn += indent + "   const " + u64 + " " + local + " = ip->operands[" + std::to_string(idx) + "];\n";
+                              locals.emplace_back(local);
+                        }
+                        for (const auto &local : locals) {
+                              retn += indent + "   (void)" + local + ";\n";
+                        }
+                        return retn + indent + "   INTERPRET_" + name + "\n" + indent + "}\n";
+                  };
 
-                        /* Create hint */
-                        std::stringstream stream;
-                        stream << std::hex << inst.first;
-                        std::string hint = stream.str();
+                  /* Create hooks, state type and dispatch selection */
+                  out.append("/* Interpreter over decoded instructions. Define INTERPRET_<MNEMONIC> to give a handler its body, it runs with state, ip,\n\
+   next (ip + 1, may be changed to jump or set to null to stop) and one const per operand in scope. INTERPRET_DISPATCH picks\n\
+   tail calls (2), computed goto (1) or switch (0), by default the fastest the compiler supports. */\n\
+#ifndef INTERPRET_STATE\n\
+#define INTERPRET_STATE void\n\
+#endif\n");
+                  for (const auto &name : names) {
+                        out.append("#ifndef INTERPRET_").append(name).append("\n#define INTERPRET_").append(name).append("\n#endif\n");
+                  }
+                  out.append("#if !defined(INTERPRET_DISPATCH) && defined(__clang__) && defined(__has_attribute)\n\
+#if __has_attribute(musttail)\n\
+#define INTERPRET_DISPATCH 2\n\
+#endif\n\
+#endif\n\
+#if !defined(INTERPRET_DISPATCH) && (defined(__GNUC__) || defined(__clang__))\n\
+#define INTERPRET_DISPATCH 1\n\
+#endif\n\
+#ifndef INTERPRET_DISPATCH\n\
+#define INTERPRET_DISPATCH 0\n\
+#endif\n\
+#if INTERPRET_DISPATCH == 2\n\
+#if defined(__clang__) && defined(__has_attribute)\n\
+#if __has_attribute(musttail)\n\
+#define INTERPRET_MUSTTAIL " + musttail + "\n\
+#endif\n\
+#endif\n\
+#ifndef INTERPRET_MUSTTAIL\n\
+#define INTERPRET_MUSTTAIL\n\
+#endif\n\
+typedef " + size + " (*interpret_handler)(INTERPRET_STATE *state, const decoded_instruction *ip, const decoded_instruction *end, " + size + " executed);\n\
+static " + size + " interpret_unknown(INTERPRET_STATE *state, const decoded_instruction *ip, const decoded_instruction *end, " + size + " executed) {\n\
+   (void)state;\n\
+   (void)ip;\n\
+   (void)end;\n\
+   return executed;\n\
+}\n");
 
-                        /* Capatalize */
-                        auto name = "OP_" + inst.second.mnemonic;
-                        std::transform(name.begin(), name.end(), name.begin(), std::toupper);
+                  /* Tail call handlers, each one jumps straight to the next. */
+                  for (const auto &name : names) {
+                        out.append("static " + size + " interpret_" + name + "(INTERPRET_STATE *state, const decoded_instruction *ip, const decoded_instruction *end, " + size + " executed);\n");
+                  }
+                  out.append("static const interpret_handler interpret_handlers[" + std::to_string(entries + 1u) + "] = {\n");
+                  std::size_t idx = 0u;
+                  this->walk_opcodes(entries, [&](const auto &, const bool used, const bool) {
+                        out.append("   ").append(used ? "interpret_" + names[idx++] : std::string("interpret_unknown")).append(",\n");
+                  });
+                  out.append("   interpret_unknown\n};\n");
+                  idx = 0u;
+                  for (const auto &inst : this->instructions) {
+                        out.append("static " + size + " interpret_" + names[idx] + "(INTERPRET_STATE *state, const decoded_instruction *ip, const decoded_instruction *end, " + size + " executed) {\n\
+   const decoded_instruction *next = ip + 1;\n\
+" + body(inst, names[idx], "   ") + "\
+   if (next == " + null + " || next >= end) {\n\
+      return executed + 1u;\n\
+   }\n\
+   INTERPRET_MUSTTAIL return interpret_handlers[(" + size + ")next->op < " + count + "u ? (" + size + ")next->op : " + count + "u](state, next, end, executed + 1u);\n\
+}\n");
+                        ++idx;
+                  }
+                  out.append("/* Run count decoded instructions from code, returns how many ran. */\n\
+static inline " + size + " interpret(INTERPRET_STATE *state, const decoded_instruction *code, " + size + " count) {\n\
+   if (count == 0u) {\n\
+      return 0u;\n\
+   }\n\
+   return interpret_handlers[(" + size + ")code->op < " + count + "u ? (" + size + ")code->op : " + count + "u](state, code, code + count, 0u);\n\
+}\n\
+#elif INTERPRET_DISPATCH == 1\n\
+/* Run count decoded instructions from code, returns how many ran. */\n\
+static inline " + size + " interpret(INTERPRET_STATE *state, const decoded_instruction *code, " + size + " count) {\n\
+   static void *const labels[" + std::to_string(entries + 1u) + "] = {\n");
 
-                        /* Create enum */
-                        switch (lang) {
-                              case language::c: { /* {??, {??, ??}}, 1 */
-                                    retn += "   {" + name + ", {";
-                                    for (auto idx = 0u; idx < inst.second.operands.size(); ++idx) {
-                                          const auto i = inst.second.operands[idx];
-                                          retn += i.kind + (idx != inst.second.operands.size() - 1u ? ", " : "");
-                                    }
-                                    retn += "}, " + std::to_string(inst.second.operands.size()) + std::string(!last ? "}," : "}");
-                                    retn += " /* " + hint + " */\n";
-                                    break;
-                              }
-                              case language::cpp: { /* {opcodes::??, {opcodes::??, {operand_kind::??, operand_kind::??}}}, 1 */
-                                    retn += "   {" + this->opcodes_enum_name + "::" + name + ", {" + this->opcodes_enum_name + "::" + name + ", {";
-                                    for (auto idx = 0u; idx < inst.second.operands.size(); ++idx) {
-                                          const auto i = inst.second.operands[idx];
-                                          retn += this->opkinds_enum_name + "::" + i.kind + (idx != inst.second.operands.size() - 1u ? ", " : "");
-                                    }
-                                    retn += "}}}" + std::string(!last ? "," : "");
-                                    retn += " /* " + hint + " */\n";
-                                    break;
-                              }
-                              default: {
-                                    break;
-                              }
-                        }
+                  /* Computed goto, every handler ends in its own indirect jump. */
+                  idx = 0u;
+                  this->walk_opcodes(entries, [&](const auto &, const bool used, const bool) {
+                        out.append("      ").append(used ? "&&interpret_" + names[idx++] : std::string("&&interpret_unknown")).append(",\n");
+                  });
+                  const auto next_goto = "      ++executed;\n\
+      if (next == " + null + " || next >= end) {\n\
+         return executed;\n\
+      }\n\
+      ip = next;\n\
+      goto *labels[(" + size + ")ip->op < " + count + "u ? (" + size + ")ip->op : " + count + "u];\n";
+                  out.append("      &&interpret_unknown};\n\
+   const decoded_instruction *ip = code;\n\
+   const decoded_instruction *end = code + count;\n\
+   const decoded_instruction *next = code;\n\
+   " + size + " executed = 0u;\n\
+   (void)state;\n\
+   if (count == 0u) {\n\
+      return 0u;\n\
+   }\n\
+   goto *labels[(" + size + ")ip->op < " + count + "u ? (" + size + ")ip->op : " + count + "u];\n");
+                  idx = 0u;
+                  for (const auto &inst : this->instructions) {
+                        out.append("interpret_" + names[idx] + ": {\n      next = ip + 1;\n" + body(inst, names[idx], "      ") + next_goto + "   }\n");
+                        ++idx;
+                  }
+                  out.append("interpret_unknown:\n\
+   return executed;\n\
+}\n\
+#else\n\
+/* Run count decoded instructions from code, returns how many ran. */\n\
+static inline " + size + " interpret(INTERPRET_STATE *state, const decoded_instruction *code, " + size + " count) {\n\
+   const decoded_instruction *ip = code;\n\
+   const decoded_instruction *end = code + count;\n\
+   " + size + " executed = 0u;\n\
+   (void)state;\n\
+   while (ip != " + null + " && ip < end) {\n\
+      const decoded_instruction *next = ip + 1;\n\
+      switch (ip->op) {\n");
+
+                  /* Portable switch */
+                  idx = 0u;
+                  for (const auto &inst : this->instructions) {
+                        out.append("         case " + scope + "OP_" + names[idx] + ":\n" + body(inst, names[idx], "         ") + "         break;\n");
+                        ++idx;
                   }
+                  out.append("         default:\n\
+            return executed;\n\
+      }\n\
+      ++executed;\n\
+      ip = next;\n\
+   }\n\
+   return executed;\n\
+}\n\
+#endif");
 
-                  return definition + retn + footer;
+                  return;
             }
 
-            /* Create opcode descriptor table */
-            template <language lang = language::cpp>
-            std::string represent_opdescriptors() {
+#pragma endregion
 
-                  std::string definition = "";
-                  std::string footer = "";
+#pragma region block cache
+
+            /* Create pre-decoded block cache over represent_decoder output, blocks hold columns narrowed to the operand widths. */
+            template <language lang = language::cpp>
+            std::string represent_block_cache() {
                   std::string retn = "";
+                  sink out = create_sink(retn);
+                  this->represent_block_cache<lang>(out);
+                  out.flush();
+                  return retn;
+            }
+
+            /* Stream block cache, a block is filled from raw bytes once and replayed from its columns after. */
+            template <language lang = language::cpp>
+            void represent_block_cache(sink &out) {
+
+                  ISCREATE_PHASE(this->statistics[phase::block_cache], &out);
 
                   /* Nothing */
                   if (this->instructions.empty()) {
-                        return retn;
+                        return;
                   }
 
-                  /* See if every entry increases by 1. */
-                  bool set = true;
-                  std::size_t next = 0u;
-                  if (next >= 0u) {
-                        for (const auto &i : this->instructions) {
-                              if (next++ != i.first) {
-                                    set = false;
-                                    break;
+                  /* Opcodes index the handler table like the decode tables. */
+                  const auto high = this->instructions.back().first;
+                  if (this->instructions.front().first < 0 || high > 0xFFFF) {
+                        std::cerr << "Block cache requires opcodes between 0 and 0xFFFF." << std::endl;
+                        return;
+                  }
+                  const auto entries = static_cast<std::size_t>(high) + 1u;
+                  const std::size_t opbytes = high > 0xFF ? 2u : 1u;
+
+                  /* Each operand column is as wide as the widest operand in its position, lengths as wide as the longest instruction. */
+                  std::vector<std::size_t> columns;
+                  std::size_t longest = 0u;
+                  for (const auto &inst : this->instructions) {
+                        const auto &operands = inst.second.operands;
+                        std::size_t length = opbytes;
+                        for (std::size_t idx = 0u; idx < operands.size(); ++idx) {
+                              const std::size_t bytes = (operands[idx].bits + 7u) / 8u;
+                              if (idx == columns.size()) {
+                                    columns.push_back(1u);
                               }
+                              columns[idx] = std::max<std::size_t>(columns[idx], bytes > 4u ? 8u : (bytes > 2u ? 4u : (bytes > 1u ? 2u : 1u)));
+                              length += bytes;
                         }
-                  } else {
-                        next = false;
+                        longest = std::max(longest, length);
+                  }
+                  const std::size_t handler_bytes = this->instructions.size() > 0x100u ? 2u : 1u;
+                  const std::size_t length_bytes = longest > 0xFFFFu ? 4u : (longest > 0xFFu ? 2u : 1u);
+                  std::size_t record = handler_bytes + length_bytes;
+                  for (const auto bytes : columns) {
+                        record += bytes;
                   }
 
-                  /* Create definition */
+                  /* Language specific spellings */
+                  std::string prefix = "";
+                  std::string table = "static const";
+                  std::string align = "_Alignas(64)";
+                  std::string null = "NULL";
+                  std::string consumed = "&consumed";
+                  std::string block_head = "typedef struct {\n";
+                  std::string block_tail = "} decoded_block;\n";
+                  std::string cache_head = "typedef struct {\n";
+                  std::string cache_tail = "} block_cache;\n";
                   switch (lang) {
                         case language::cpp: {
-                              definition = "struct optable_descriptor {\n\
-   const char * opname;\n\
-   const char * mnemonic;\n\
-   const char * hint;\n\
-   std::vector<const char *> operand_encodings;\n\
-};\n\
-static std::map<" + this->opcodes_enum_name + ", optable_descriptor> opdescriptor = {\n";
+                              prefix = "std::";
+                              table = "static constexpr";
+                              align = "alignas(64)";
+                              null = "nullptr";
+                              consumed = "consumed";
+                              block_head = "struct decoded_block {\n";
+                              block_tail = "};\n";
+                              cache_head = "struct block_cache {\n";
+                              cache_tail = "};\n";
                               break;
                         }
                         case language::c: {
-                              definition = "struct optable_descriptor {\n\
-   const char * opname;\n\
-   const char * mnemonic;\n\
-   const char * hint;\n\
-   const char* []operand_encodings;\n\
-   size_t num_operand_encoding;\n\
-};\n\
-static struct optable_descriptor opdescriptor[] = {\n";
                               break;
                         }
                         default: {
                               break;
                         }
                   }
+                  const auto type = [&](const std::size_t bytes) {
+                        return prefix + (bytes > 4u ? "uint64_t" : (bytes > 2u ? "uint32_t" : (bytes > 1u ? "uint16_t" : "uint8_t")));
+                  };
+                  const auto cast = [&](const std::size_t bytes, const std::string &value) {
+                        return lang == language::cpp ? "static_cast<" + type(bytes) + ">(" + value + ")" : "(" + type(bytes) + ")" + value;
+                  };
+                  const auto size = prefix + "size_t";
+                  const auto u64 = prefix + "uint64_t";
 
-                  /* Create footer */
-                  switch (lang) {
-                        case language::cpp: {
-                              footer = "};";
-                              break;
-                        }
-                        case language::c: {
-                              footer = "};";
-                              break;
-                        }
-                        default: {
-                              break;
-                        }
+                  /* Create hooks and block layout */
+                  out.append("/* Pre-decoded blocks, " + std::to_string(record) + " bytes per instruction in columns of handler index (instruction ordinal), length and\n\
+   operands narrowed to the widest operand in each position. BLOCK_ENDS(op) ends a block after op, such as after a branch. */\n\
+#ifndef BLOCK_CAPACITY\n\
+#define BLOCK_CAPACITY 64\n\
+#endif\n\
+#ifndef BLOCK_CACHE_SIZE\n\
+#define BLOCK_CACHE_SIZE 256\n\
+#endif\n\
+#ifndef BLOCK_ENDS\n\
+#define BLOCK_ENDS(op) 0\n\
+#endif\n" + block_head + "\
+   " + u64 + " address;\n\
+   " + size + " count;\n\
+   " + size + " size;\n\
+   " + align + " " + type(handler_bytes) + " handlers[BLOCK_CAPACITY];\n\
+   " + align + " " + type(length_bytes) + " lengths[BLOCK_CAPACITY];\n");
+                  for (std::size_t idx = 0u; idx < columns.size(); ++idx) {
+                        out.append("   " + align + " " + type(columns[idx]) + " operand" + std::to_string(idx) + "[BLOCK_CAPACITY];\n");
                   }
+                  out.append(block_tail + cache_head + "\
+   " + u64 + " tags[BLOCK_CACHE_SIZE]; /* Block address + 1, 0 is empty. */\n\
+   decoded_block blocks[BLOCK_CACHE_SIZE];\n" + cache_tail);
 
+                  /* Create opcode to handler and handler to opcode tables */
+                  out.append(table + " " + type(handler_bytes) + " block_handlers[" + std::to_string(entries) + "] = {\n");
+                  std::size_t ordinal = 0u;
+                  this->walk_opcodes(entries, [&](const auto &inst, const bool used, const bool last) {
+                        out.append("   ").append(std::to_string(used ? ordinal++ : 0u)).append(!last ? "," : "");
+                        if (used) {
+                              out.append(" /* ").append(this->str(inst->second.mnemonic)).append(" */");
+                        }
+                        out.append("\n");
+                  });
+                  out.append("};\n" + table + " " + this->opcodes_enum_name + " block_opcodes[" + std::to_string(this->instructions.size()) + "] = {\n");
+                  ordinal = 0u;
                   for (const auto &inst : this->instructions) {
+                        out.append(lang == language::cpp ? "   " + this->opcodes_enum_name + "::" : "   ");
+                        this->append_enumerator(out, this->str(inst.second.mnemonic)).append(++ordinal != this->instructions.size() ? ",\n" : "\n");
+                  }
 
-                        const auto last = inst.first == this->instructions.rbegin()->first;
+                  /* Create fill, lookup and replay */
+                  out.append("};\n\
+/* Decode up to BLOCK_CAPACITY instructions of code into block, address is where code starts. Returns the instruction count,\n\
+   the block ends early on an unknown opcode, a truncated instruction or BLOCK_ENDS. */\n\
+static inline " + size + " block_fill(decoded_block *block, const " + prefix + "uint8_t *code, " + size + " size, " + u64 + " address) {\n\
+   decoded_instruction inst;\n\
+   " + size + " offset = 0u;\n\
+   " + size + " n = 0u;\n\
+   while (n < BLOCK_CAPACITY) {\n\
+      " + size + " consumed = 0u;\n\
+      if (decode(code + offset, size - offset, &inst, 1u, " + consumed + ") == 0u) {\n\
+         break;\n\
+      }\n\
+      block->handlers[n] = block_handlers[" + (lang == language::cpp ? "static_cast<std::size_t>(inst.op)" : "(size_t)inst.op") + "];\n\
+      block->lengths[n] = " + cast(length_bytes, "consumed") + ";\n");
+                  for (std::size_t idx = 0u; idx < columns.size(); ++idx) {
+                        out.append("      block->operand" + std::to_string(idx) + "[n] = " + cast(columns[idx], "inst.operands[" + std::to_string(idx) + "]") + ";\n");
+                  }
+                  out.append("\
+      offset += consumed;\n\
+      ++n;\n\
+      if (BLOCK_ENDS(inst.op)) {\n\
+         break;\n\
+      }\n\
+   }\n\
+   block->address = address;\n\
+   block->count = n;\n\
+   block->size = offset;\n\
+   return n;\n\
+}\n\
+/* Block at address of code, decoded on first use. Zero the cache before first use and whenever code changes. */\n\
+static inline const decoded_block *block_lookup(block_cache *cache, const " + prefix + "uint8_t *code, " + size + " size, " + u64 + " address) {\n\
+   const " + size + " slot = " + (lang == language::cpp ? "static_cast<std::size_t>" : "(size_t)") + "((address ^ (address >> 16u)) % BLOCK_CACHE_SIZE);\n\
+   if (cache->tags[slot] != address + 1u) {\n\
+      if (address >= size) {\n\
+         return " + null + ";\n\
+      }\n\
+      block_fill(&cache->blocks[slot], code + address, size - " + (lang == language::cpp ? "static_cast<std::size_t>(address)" : "(size_t)address") + ", address);\n\
+      cache->tags[slot] = address + 1u;\n\
+   }\n\
+   return &cache->blocks[slot];\n\
+}\n\
+typedef void (*block_handler)(void *state, const decoded_block *block, " + size + " idx);\n\
+/* Run handlers[handler index] for every instruction of block in order. */\n\
+static inline void block_replay(const decoded_block *block, const block_handler *handlers, void *state) {\n\
+   for (" + size + " idx = 0u; idx < block->count; ++idx) {\n\
+      handlers[block->handlers[idx]](state, block, idx);\n\
+   }\n\
+}");
 
-                        /* Create hint */
-                        std::stringstream stream;
-                        stream << std::hex << inst.first;
-                        std::string hint = stream.str();
+                  return;
+            }
 
-                        /* Capatalize */
-                        auto name = "OP_" + inst.second.mnemonic;
-                        std::transform(name.begin(), name.end(), name.begin(), std::toupper);
+#pragma endregion
 
-                        /* Create enum */
-                        switch (lang) {
-                              case language::c: { /* {??, {??, ??}}, 1 */
-                                    retn += "   {" + name + ", {\"" + name + "\", \"" + inst.second.mnemonic + "\", \"" + inst.second.hint + "\", {";
-                                    for (auto idx = 0u; idx < inst.second.operands.size(); ++idx) {
-                                          const auto i = inst.second.operands[idx];
-                                          retn += "\"" + i.operand_ + "(" + i.hint + ")\"" + (idx != inst.second.operands.size() - 1u ? ", " : "");
-                                    }
-                                    retn += "}, " + std::to_string(inst.second.operands.size()) + std::string(!last ? "}," : "}");
-                                    retn += " /* " + hint + " */\n";
-                                    break;
+#pragma endregion
+
+#pragma region hash
+
+            /* Hash of everything the selected artifacts are created from, artifacts only change when it does. */
+            template <language lang = language::cpp, table mode = table::map>
+            std::uint64_t fingerprint(const std::uint8_t which = artifact::all) const {
+
+                  /* Bump when generated code changes for the same input. */
+                  constexpr std::uint64_t generator = 1u;
+
+                  fnv1a hash;
+                  hash.add(generator).add(static_cast<std::uint64_t>(lang)).add(static_cast<std::uint64_t>(mode)).add(static_cast<std::uint64_t>(which));
+
+                  const auto want = [which](const std::uint8_t a) {
+                        return (which & a) != 0u;
+                  };
+
+                  if (want(artifact::enum_opencodings)) {
+                        hash.add(this->opencodings_enum_name).add(static_cast<std::uint64_t>(this->encodings.size()));
+                        for (const auto id : this->encodings) {
+                              hash.add(this->str(id));
+                        }
+                  }
+                  if (want(artifact::enum_opkinds)) {
+                        hash.add(this->opkinds_enum_name).add(static_cast<std::uint64_t>(this->kinds.size()));
+                        for (const auto id : this->kinds) {
+                              hash.add(this->str(id));
+                        }
+                  }
+
+                  /* Only the instruction fields the selected artifacts print */
+                  const auto names = want(artifact::enum_opcodes) || want(artifact::opdescriptors);
+                  const auto tables = want(artifact::opencodings) || want(artifact::opkinds) || want(artifact::opdescriptors);
+                  if (!want(artifact::enum_opcodes) && !tables) {
+                        return hash.value();
+                  }
+
+                  hash.add(this->opcodes_enum_name);
+                  if (want(artifact::opencodings)) {
+                        hash.add(this->opencodings_enum_name);
+                  }
+                  if (want(artifact::opkinds)) {
+                        hash.add(this->opkinds_enum_name);
+                  }
+                  hash.add(static_cast<std::uint64_t>(this->instructions.size()));
+                  for (const auto &inst : this->instructions) {
+                        hash.add(static_cast<std::uint64_t>(inst.first)).add(this->str(inst.second.mnemonic));
+                        if (names) {
+                              hash.add(this->str(inst.second.hint));
+                        }
+                        hash.add(static_cast<std::uint64_t>(inst.second.operands.size()));
+                        for (const auto &op : inst.second.operands) {
+                              if (names) {
+                                    hash.add(this->str(op.operand_));
                               }
-                              case language::cpp: { /* {opcodes::??, {opcodes::??, {operand_kind::??, operand_kind::??}}}, 1 */
-                                    retn += "   {" + this->opcodes_enum_name + "::" + name + ", {\"" + name + "\", \"" + inst.second.mnemonic + "\", \"" + inst.second.hint + "\", {";
-                                    for (auto idx = 0u; idx < inst.second.operands.size(); ++idx) {
-                                          const auto i = inst.second.operands[idx];
-                                          retn += "\"" + i.operand_ + "(" + i.hint + ")\"" + (idx != inst.second.operands.size() - 1u ? ", " : "");
-                                    }
-                                    retn += "}}}" + std::string(!last ? "," : "");
-                                    retn += " /* " + hint + " */\n";
-                                    break;
+                              if (want(artifact::enum_opcodes)) {
+                                    hash.add(this->str(op.size));
                               }
-                              default: {
-                                    break;
+                              if (want(artifact::opencodings)) {
+                                    hash.add(this->str(op.encoding));
+                              }
+                              if (want(artifact::opkinds)) {
+                                    hash.add(this->str(op.kind));
+                              }
+                              if (want(artifact::opdescriptors)) {
+                                    hash.add(this->str(op.hint));
                               }
                         }
                   }
 
-                  return definition + retn + footer;
+                  return hash.value();
             }
 
-#pragma endregion
-
 #pragma endregion
 
             /* Remove every instruction */
             void clear() {
                   instructions.clear();
+                  symbols.clear();
+                  roles.clear();
+                  encodings.clear();
+                  kinds.clear();
+                  sizes.clear();
+                  by_mnemonic.clear();
+                  by_encoding.clear();
+                  by_kind.clear();
+                  by_size.clear();
+                  indexed.invalidate();
+                  return;
+            }
+
+            /* Heap bytes held by the set, available with or without ISCREATE_STATS. */
+            memory_breakdown memory_usage() const {
+                  this->reindex();
+                  memory_breakdown retn;
+                  retn.instructions = this->instructions.instruction_bytes();
+                  retn.operands = this->instructions.operand_bytes();
+                  retn.strings = this->symbols.memory_usage();
+                  retn.indexes = this->roles.capacity() + (this->encodings.capacity() + this->kinds.capacity() + this->sizes.capacity()) * sizeof(symbol);
+                  for (const auto *index : {&this->by_mnemonic, &this->by_encoding, &this->by_kind, &this->by_size}) {
+                        retn.indexes += index->capacity() * sizeof(std::vector<std::intptr_t>);
+                        for (const auto &list : *index) {
+                              retn.indexes += list.capacity() * sizeof(std::intptr_t);
+                        }
+                  }
+                  return retn;
+            }
+
+#if defined(ISCREATE_STATS)
+            /* Phase stats recorded so far with the current memory usage */
+            set_stats stats() const {
+                  auto retn = this->statistics.load();
+                  retn.memory = this->memory_usage();
+                  return retn;
+            }
+
+            /* Stats of one phase, for recording phases driven from outside the set. */
+            phase_counters &stats(const phase which) {
+                  return this->statistics[which];
+            }
+
+            void reset_stats() {
+                  this->statistics.reset();
                   return;
             }
+#endif
+
+            /* View instructions without copying, prefer this over data(). */
+            instruction_view view() const {
+                  return instruction_view(&this->symbols, &this->instructions);
+            }
 
             /* Return instruction data */
             std::map<std::intptr_t, instruction> data() {
-                  return this->instructions;
+                  std::map<std::intptr_t, instruction> retn;
+                  for (const auto &inst : this->instructions) {
+                        instruction i;
+                        i.mnemonic = this->str(inst.second.mnemonic);
+                        i.hint = this->str(inst.second.hint);
+                        i.operands.reserve(inst.second.operands.size());
+                        for (const auto &op : inst.second.operands) {
+                              i.operands.emplace_back(operand{this->str(op.operand_), this->str(op.encoding), this->str(op.size), this->str(op.hint), this->str(op.kind)});
+                        }
+                        retn.emplace_hint(retn.end(), inst.first, std::move(i));
+                  }
+                  return retn;
+            }
+
+#pragma region symbols
+
+            /* String behind an interned field */
+            const std::string &str(symbol id) const {
+                  return this->symbols.str(id);
+            }
+
+            /* Shared string pool */
+            const symbol_pool &pool() const {
+                  return this->symbols;
             }
 
+            /* Distinct operand encodings in first use order */
+            const std::vector<symbol> &operand_encodings() const {
+                  return this->encodings;
+            }
+
+            /* Distinct operand kinds in first use order */
+            const std::vector<symbol> &operand_kinds() const {
+                  return this->kinds;
+            }
+
+            /* Distinct operand sizes in first use order */
+            const std::vector<symbol> &operand_sizes() const {
+                  return this->sizes;
+            }
+
+#pragma endregion
+
+#pragma region query
+
+            /* First instruction with mnemonic */
+            bool find_mnemonic(const std::string &mnemonic, instruction_ref &out) const {
+                  const auto found = this->with_mnemonic(mnemonic);
+                  if (found.empty()) {
+                        return false;
+                  }
+                  out = found.at(0u);
+                  return true;
+            }
+
+            /* Instructions with mnemonic */
+            instruction_query with_mnemonic(const std::string &mnemonic) const {
+                  this->reindex();
+                  return this->query(this->by_mnemonic, mnemonic);
+            }
+
+            /* Instructions with an operand of encoding */
+            instruction_query with_encoding(const std::string &encoding) const {
+                  this->reindex();
+                  return this->query(this->by_encoding, encoding);
+            }
+
+            /* Instructions with an operand of kind */
+            instruction_query with_kind(const std::string &kind) const {
+                  this->reindex();
+                  return this->query(this->by_kind, kind);
+            }
+
+            /* Instructions with an operand of size */
+            instruction_query with_size(const std::string &size) const {
+                  this->reindex();
+                  return this->query(this->by_size, size);
+            }
+
+#pragma endregion
+
             std::string opcodes_enum_name = "opcodes";
             std::string opencodings_enum_name = "operand_encoding";
             std::string opkinds_enum_name = "operand_kind";
 
+            /* Escape byte prefixes that open an opcode map for represent_dispatch, e.g. {0x0F} and {0x0F, 0x38}.
+               An opcode is its prefix bytes followed by one byte, 0x0F3801 is 01 in map 0F 38, opcodes below 0x100 are in the root map. */
+            std::vector<std::vector<std::uint8_t>> opcode_maps;
+
           private:
-            std::map<std::intptr_t, instruction> instructions;
+            /* Which operand fields a symbol has been used for */
+            enum role : std::uint8_t {
+                  role_encoding = 1u << 0u,
+                  role_kind = 1u << 1u,
+                  role_size = 1u << 2u
+            };
+
+            /* Intern and insert, an existing opcode is kept like std::map::insert. Strings of rvalue arguments are moved into the pool. */
+            template <typename mnemonic_string, typename hint_string, typename operand_list>
+            void insert(const std::intptr_t opcode, mnemonic_string &&mnemonic, hint_string &&hint, operand_list &&operands) {
+                  ISCREATE_PHASE(this->statistics[phase::insert], nullptr);
+                  if (this->instructions.contains(opcode)) {
+                        return;
+                  }
+
+                  constexpr auto movable = !std::is_lvalue_reference_v<operand_list>;
+                  const auto field = [](auto &str) -> decltype(auto) {
+                        if constexpr (movable) {
+                              return std::move(str);
+                        } else {
+                              return static_cast<const std::string &>(str);
+                        }
+                  };
+
+                  const auto m = this->symbols.intern(std::forward<mnemonic_string>(mnemonic));
+                  const auto h = this->symbols.intern(std::forward<hint_string>(hint));
+                  this->scratch.clear();
+                  for (auto &op : operands) {
+                        interned_operand o;
+                        o.bits = static_cast<std::uint32_t>(operand_bits(op.size));
+                        o.operand_ = this->symbols.intern(field(op.operand_));
+                        o.encoding = this->intern_field(field(op.encoding), role_encoding, this->encodings);
+                        o.size = this->intern_field(field(op.size), role_size, this->sizes);
+                        o.hint = this->symbols.intern(field(op.hint));
+                        o.kind = this->intern_field(field(op.kind), role_kind, this->kinds);
+                        this->scratch.emplace_back(o);
+                  }
+                  this->instructions.insert(opcode, m, h, this->scratch);
+
+                  /* In order adds extend current indexes, anything else leaves them for the next query to rebuild. */
+                  if (this->indexed.stale() || !this->instructions.ordered_inserts()) {
+                        this->indexed.invalidate();
+                        return;
+                  }
+                  this->post(opcode, m, operand_span(this->scratch.data(), this->scratch.size()));
+                  return;
+            }
+
+            /* Append opcode to the posting lists of its fields, it is above every opcode already posted. */
+            void post(const std::intptr_t opcode, const symbol mnemonic, const operand_span operands) const {
+                  const auto append = [opcode](std::vector<std::vector<std::intptr_t>> &index, const symbol id) {
+                        if (index.size() <= id) {
+                              index.resize(id + 1u);
+                        }
+                        auto &list = index[id];
+                        if (list.empty() || list.back() != opcode) {
+                              list.emplace_back(opcode);
+                        }
+                        return;
+                  };
+                  append(this->by_mnemonic, mnemonic);
+                  for (const auto &o : operands) {
+                        append(this->by_encoding, o.encoding);
+                        append(this->by_kind, o.kind);
+                        append(this->by_size, o.size);
+                  }
+                  return;
+            }
+
+            /* Rebuild the posting lists in one pass over the store when adds left them stale. */
+            void reindex() const {
+                  this->indexed.refresh([this]() {
+                        for (auto *index : {&this->by_mnemonic, &this->by_encoding, &this->by_kind, &this->by_size}) {
+                              index->clear();
+                        }
+                        for (const auto &inst : this->instructions) {
+                              this->post(inst.first, inst.second.mnemonic, inst.second.operands);
+                        }
+                  });
+                  return;
+            }
+
+            /* Posting list of str as a query, empty when str was never used for the index. */
+            instruction_query query(const std::vector<std::vector<std::intptr_t>> &index, const std::string &str) const {
+                  const auto id = this->symbols.find(str);
+                  return instruction_query(&this->symbols, &this->instructions, id < index.size() ? &index[id] : nullptr);
+            }
+
+            /* Intern operand field and record the first time a value is used for it. */
+            template <typename string>
+            symbol intern_field(string &&str, const role field, std::vector<symbol> &distinct) {
+                  const auto id = this->symbols.intern(std::forward<string>(str));
+                  if (this->roles.size() <= id) {
+                        this->roles.resize(id + 1u, 0u);
+                  }
+                  if (!(this->roles[id] & field)) {
+                        this->roles[id] |= field;
+                        distinct.emplace_back(id);
+                  }
+                  return id;
+            }
+
+            /* Seeded 32 bit FNV-1a with a final mix, generated lookups carry the same function. */
+            static std::uint32_t mnemonic_hash(const std::string &str, const std::uint32_t seed) {
+                  std::uint32_t hash = 2166136261u ^ seed;
+                  for (const auto c : str) {
+                        hash = (hash ^ static_cast<std::uint8_t>(c)) * 16777619u;
+                  }
+                  hash ^= hash >> 16u;
+                  hash *= 0x85ebca6bu;
+                  hash ^= hash >> 13u;
+                  return hash;
+            }
+
+            /* Append str in upper case to a string or sink. */
+            template <typename output>
+            static output &append_upper(output &out, const std::string &str) {
+                  for (const auto c : str) {
+                        const char upper = c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c;
+                        out.append(&upper, 1u);
+                  }
+                  return out;
+            }
+
+            /* Append the opcodes enumerator of a mnemonic to a string or sink, OP_ and the mnemonic in upper case. */
+            template <typename output>
+            static output &append_enumerator(output &out, const std::string &mnemonic) {
+                  return append_upper(out.append("OP_", 3u), mnemonic);
+            }
+
+            /* Lowercase C and C++ identifier from free text, keywords and names the generated code relies on get a trailing _. */
+            static std::string identifier(const std::string &str) {
+                  static const std::unordered_set<std::string_view> reserved = {
+                      "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case", "catch", "char", "char8_t", "char16_t", "char32_t",
+                      "class", "compl", "concept", "const", "consteval", "constexpr", "constinit", "const_cast", "continue", "co_await", "co_return", "co_yield", "decltype",
+                      "default", "delete", "do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false", "float", "for", "friend", "goto", "if",
+                      "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq", "nullptr", "operator", "or", "or_eq", "private", "protected",
+                      "public", "register", "reinterpret_cast", "requires", "restrict", "return", "short", "signed", "sizeof", "static", "static_assert", "static_cast",
+                      "struct", "switch", "template", "this", "thread_local", "throw", "true", "try", "typedef", "typeid", "typename", "union", "unsigned", "using",
+                      "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq", "std", "size_t", "int8_t", "int16_t", "int32_t", "int64_t", "uint8_t",
+                      "uint16_t", "uint32_t", "uint64_t"};
+                  std::string retn = "";
+                  for (const auto c : str) {
+                        const auto lower = c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+                        retn += (lower >= 'a' && lower <= 'z') || (lower >= '0' && lower <= '9') || lower == '_' ? lower : '_';
+                  }
+                  if (retn.empty() || (retn[0] >= '0' && retn[0] <= '9')) {
+                        retn.insert(0u, "_");
+                  }
+                  if (reserved.count(retn) != 0u) {
+                        retn += "_";
+                  }
+                  return retn;
+            }
+
+            /* Call row for every opcode below entries in order, inst only points at the opcode when used. */
+            template <typename callable>
+            void walk_opcodes(const std::size_t entries, const callable &row) const {
+                  auto inst = this->instructions.begin();
+                  for (std::size_t opcode = 0u; opcode < entries; ++opcode) {
+                        const auto used = inst != this->instructions.end() && inst->first == static_cast<std::intptr_t>(opcode);
+                        row(inst, used, opcode == entries - 1u);
+                        if (used) {
+                              ++inst;
+                        }
+                  }
+                  return;
+            }
+
+            instruction_store instructions;
+            symbol_pool symbols;
+            std::vector<std::uint8_t> roles;
+            std::vector<symbol> encodings;
+            std::vector<symbol> kinds;
+            std::vector<symbol> sizes;
+            mutable std::vector<std::vector<std::intptr_t>> by_mnemonic; /* Opcodes per symbol, rebuilt by queries after out of order adds */
+            mutable std::vector<std::vector<std::intptr_t>> by_encoding;
+            mutable std::vector<std::vector<std::intptr_t>> by_kind;
+            mutable std::vector<std::vector<std::intptr_t>> by_size;
+            refresh_guard indexed;
+            std::vector<interned_operand> scratch; /* Operands of the instruction being inserted, reused between inserts. */
+#if defined(ISCREATE_STATS)
+            mutable stats_recorder statistics; /* Recording does not change the set, concurrent generators may record at once. */
+#endif
             std::string name = "";
       };
 
+      /* Compiled binary layout, native endian and 8 byte aligned throughout. */
+      namespace binary {
+
+            constexpr char magic[4] = {'I', 'S', 'C', 'B'};
+            constexpr std::uint32_t version = 1u;
+            constexpr std::uint32_t endian = 0x01020304u;
+
+            /* Offset and length inside the string table */
+            struct string_ref {
+                  std::uint32_t offset;
+                  std::uint32_t length;
+            };
+
+            struct header {
+                  char magic[4];
+                  std::uint32_t version;
+                  std::uint32_t endian;
+                  std::uint32_t reserved;
+                  std::uint64_t instructions;       /* Instruction records, sorted by opcode, follow the header */
+                  std::uint64_t operands_offset;    /* Operand records */
+                  std::uint64_t operands;
+                  std::uint64_t strings_offset;     /* Deduplicated string table */
+                  std::uint64_t strings_size;
+            };
+
+            struct instruction_record {
+                  std::int64_t opcode;
+                  string_ref mnemonic;
+                  string_ref hint;
+                  std::uint32_t first_operand;
+                  std::uint32_t num_operands;
+            };
+
+            struct operand_record {
+                  string_ref operand_;
+                  string_ref encoding;
+                  string_ref size;
+                  string_ref hint;
+                  string_ref kind;
+            };
+
+      } // namespace binary
+
+      /* Operand inside a compiled set, strings point into the mapping. */
+      class compiled_operand {
+
+          public:
+            compiled_operand() = default;
+            compiled_operand(const char *strings, const binary::operand_record *record)
+                : strings(strings), record(record) {
+            }
+
+            std::string_view operand_() const {
+                  return this->str(this->record->operand_);
+            }
+
+            std::string_view encoding() const {
+                  return this->str(this->record->encoding);
+            }
+
+            std::string_view size() const {
+                  return this->str(this->record->size);
+            }
+
+            std::string_view hint() const {
+                  return this->str(this->record->hint);
+            }
+
+            std::string_view kind() const {
+                  return this->str(this->record->kind);
+            }
+
+          private:
+            std::string_view str(const binary::string_ref &ref) const {
+                  return std::string_view(this->strings + ref.offset, ref.length);
+            }
+
+            const char *strings = nullptr;
+            const binary::operand_record *record = nullptr;
+      };
+
+      /* Instruction inside a compiled set, strings point into the mapping. */
+      class compiled_instruction {
+
+          public:
+            compiled_instruction() = default;
+            compiled_instruction(const char *strings, const binary::instruction_record *record, const binary::operand_record *operands)
+                : strings(strings), record(record), operands(operands) {
+            }
+
+            std::intptr_t opcode() const {
+                  return static_cast<std::intptr_t>(this->record->opcode);
+            }
+
+            std::string_view mnemonic() const {
+                  return std::string_view(this->strings + this->record->mnemonic.offset, this->record->mnemonic.length);
+            }
+
+            std::string_view hint() const {
+                  return std::string_view(this->strings + this->record->hint.offset, this->record->hint.length);
+            }
+
+            /* Number of operands */
+            std::size_t size() const {
+                  return this->record->num_operands;
+            }
+
+            compiled_operand at(std::size_t idx) const {
+                  return compiled_operand(this->strings, this->operands + this->record->first_operand + idx);
+            }
+
+          private:
+            const char *strings = nullptr;
+            const binary::instruction_record *record = nullptr;
+            const binary::operand_record *operands = nullptr;
+      };
+
+      /* Read only instruction set used straight out of a mapped compiled binary file. */
+      class compiled_set {
+
+          public:
+            compiled_set(const std::string &dir);
+
+            /* File is mapped and passed validation. */
+            bool is_open() const {
+                  return this->valid;
+            }
+
+            /* Number of instructions */
+            std::size_t size() const {
+                  return this->count;
+            }
+
+            /* Instruction by position, ordered by opcode. */
+            compiled_instruction at(std::size_t idx) const {
+                  return compiled_instruction(this->strings, this->instructions + idx, this->operands);
+            }
+
+            /* Instruction by opcode */
+            bool find(std::intptr_t opcode, compiled_instruction &out) const {
+                  const auto end = this->instructions + this->count;
+                  const auto it = std::lower_bound(this->instructions, end, opcode, [](const binary::instruction_record &record, std::intptr_t opcode) {
+                        return record.opcode < opcode;
+                  });
+                  if (it == end || it->opcode != opcode) {
+                        return false;
+                  }
+                  out = compiled_instruction(this->strings, it, this->operands);
+                  return true;
+            }
+
+          private:
+            mapped_file file;
+            bool valid = false;
+            std::size_t count = 0u;
+            const binary::instruction_record *instructions = nullptr;
+            const binary::operand_record *operands = nullptr;
+            const char *strings = nullptr;
+      };
+
       /* Create operand */
       __inline operand create_operand(const std::string &operand_ = "", const std::string &encoding = "", const std::string &size = "", const std::string &hint = "", const std::string &kind = "") {
             operand retn;
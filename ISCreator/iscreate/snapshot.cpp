@@ -0,0 +1,32 @@
+#include "snapshot.hpp"
+
+iscreate::snapshot_store::snapshot_store(const std::string &name)
+    : current(std::make_shared<const snapshot>(instruction_set(name), 0u)) {
+}
+
+iscreate::snapshot_ptr iscreate::snapshot_store::publish(instruction_set &&set) {
+
+      /* set was built off to the side, under the lock it is only moved, numbered and swapped in. */
+      const std::lock_guard<std::mutex> guard(this->writers);
+      const auto version = this->published.load(std::memory_order_relaxed) + 1u;
+      snapshot_ptr next = std::make_shared<const snapshot>(std::move(set), version);
+
+      /* The snapshot goes out before its version so a reader that sees the version also sees the snapshot. */
+      auto previous = this->current.exchange(std::move(next), std::memory_order_acq_rel);
+      this->published.store(version, std::memory_order_release);
+
+      return previous;
+}
+
+bool iscreate::snapshot_store::reload(const std::string &dir, const std::string &name) {
+
+      /* A spec that stops partway would publish a partial set, only a complete load replaces the current snapshot. */
+      instruction_set set(name);
+      if (!set.try_load(dir)) {
+            return false;
+      }
+
+      this->publish(std::move(set));
+
+      return true;
+}
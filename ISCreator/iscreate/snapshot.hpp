@@ -0,0 +1,99 @@
+#pragma once
+#include "iscreate.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace iscreate {
+
+      /* Immutable instruction set shared by any number of reader threads, only const queries are reachable. */
+      class snapshot {
+
+          public:
+            snapshot(instruction_set &&set, const std::uint64_t version)
+                : contents(std::move(set)), number(version) {
+            }
+
+            snapshot(const snapshot &) = delete;
+            snapshot &operator=(const snapshot &) = delete;
+
+            const instruction_set &set() const {
+                  return this->contents;
+            }
+
+            instruction_view view() const {
+                  return this->contents.view();
+            }
+
+            /* Publication number, each publish of a store counts up from 1. */
+            std::uint64_t version() const {
+                  return this->number;
+            }
+
+          private:
+            const instruction_set contents;
+            const std::uint64_t number = 0u;
+      };
+
+      typedef std::shared_ptr<const snapshot> snapshot_ptr;
+
+      /* Publication point of the current snapshot. Readers keep a snapshot as long as they like, writers build a replacement
+         off to the side and swap it in, the old one is freed when its last reader lets go. Hot paths should read through a
+         snapshot_reader, acquire() goes through std::atomic<std::shared_ptr> which is not lock-free on libstdc++ or MSVC. */
+      class snapshot_store {
+
+          public:
+            /* Starts out publishing an empty set */
+            snapshot_store(const std::string &name = "");
+
+            snapshot_store(const snapshot_store &) = delete;
+            snapshot_store &operator=(const snapshot_store &) = delete;
+
+            /* Current snapshot. Not lock-free, the load briefly holds the same internal lock bit as a publish. */
+            snapshot_ptr acquire() const {
+                  return this->current.load(std::memory_order_acquire);
+            }
+
+            /* Version of the current snapshot, a single atomic load for readers polling for changes. */
+            std::uint64_t version() const {
+                  return this->published.load(std::memory_order_acquire);
+            }
+
+            /* Make set the current snapshot, returns the one it replaced. */
+            snapshot_ptr publish(instruction_set &&set);
+
+            /* Load a spec into a new set and publish it, a spec that fails to load completely keeps the current snapshot. */
+            bool reload(const std::string &dir, const std::string &name = "");
+
+          private:
+            std::atomic<snapshot_ptr> current; /* Not lock-free, is_lock_free() is false on libstdc++ and MSVC. */
+            std::atomic<std::uint64_t> published{0u};
+            std::mutex writers; /* Orders publishers only, readers never take it. */
+      };
+
+      /* Reader side handle for one thread and the hot path for readers. It keeps the snapshot it last saw and polls the
+         lock-free version counter, acquire() and its internal lock are only reached once after each publish. */
+      class snapshot_reader {
+
+          public:
+            snapshot_reader(const snapshot_store &store)
+                : store(&store), held(store.acquire()) {
+            }
+
+            /* Current snapshot, stays valid until the next call even when a newer one is published meanwhile. */
+            const snapshot &get() {
+                  if (this->store->version() != this->held->version()) {
+                        this->held = this->store->acquire();
+                  }
+                  return *this->held;
+            }
+
+          private:
+            const snapshot_store *store = nullptr;
+            snapshot_ptr held;
+      };
+
+} // namespace iscreate
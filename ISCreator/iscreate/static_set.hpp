@@ -0,0 +1,321 @@
+#pragma once
+#include "iscreate.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace iscreate {
+
+      /* Operand of a compile time instruction, fields match operand. */
+      struct static_operand {
+            std::string_view operand_ = "";
+            std::string_view encoding = "";
+            std::string_view size = "";
+            std::string_view hint = "";
+            std::string_view kind = "";
+      };
+
+      /* Compile time instruction with its operands inline */
+      template <std::size_t operand_count>
+      struct static_instruction {
+            template <typename... operands>
+            constexpr static_instruction(const std::intptr_t opcode, const std::string_view mnemonic, const std::string_view hint, const operands &...ops)
+                : opcode(opcode), mnemonic(mnemonic), hint(hint), operands_{ops...} {
+            }
+
+            std::intptr_t opcode = 0;
+            std::string_view mnemonic = "";
+            std::string_view hint = "";
+            std::array<static_operand, operand_count> operands_;
+      };
+
+      template <typename... operands>
+      static_instruction(std::intptr_t, std::string_view, std::string_view, operands...) -> static_instruction<sizeof...(operands)>;
+
+      /* Row of the opcode indexed tables, operands are first to first + count - 1 of the operand tables. */
+      struct static_optable {
+            std::intptr_t opcode = 0;
+            std::string_view mnemonic = "";
+            std::string_view hint = "";
+            std::size_t first = 0u;
+            std::size_t count = 0u;
+      };
+
+      /* Instruction set built at compile time, tables follow the flat layout represent_* emits.
+         Rows are in opcode order like the opcodes enum, whose values are the opcodes themselves, so find(opcode) gives the row of an enum value.
+         Encodings and kinds are listed in first use order so their index is the operand_encoding and operand_kind enum value. */
+      template <std::size_t instructions, std::size_t operands>
+      class static_set {
+
+          public:
+            static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+            template <typename... definition_types>
+            constexpr static_set(const definition_types &...defs) {
+
+                  /* Definition order decides which encodings and kinds come first, like add order does at runtime. */
+                  std::array<staged, instructions> staging = {};
+                  std::array<static_operand, operands> written = {};
+                  std::size_t row = 0u;
+                  std::size_t at = 0u;
+                  (this->stage(defs, staging, written, row, at), ...);
+
+                  /* Rows into opcode order, a repeated opcode is an error. */
+                  for (std::size_t idx = 1u; idx < instructions; ++idx) {
+                        for (auto prev = idx; prev > 0u && staging[prev].opcode < staging[prev - 1u].opcode; --prev) {
+                              std::swap(staging[prev], staging[prev - 1u]);
+                        }
+                  }
+                  for (std::size_t idx = 1u; idx < instructions; ++idx) {
+                        if (staging[idx - 1u].opcode == staging[idx].opcode) {
+                              throw "Duplicate opcode in static instruction set.";
+                        }
+                  }
+
+                  /* Operands of each row in row order */
+                  std::size_t first = 0u;
+                  for (std::size_t idx = 0u; idx < instructions; ++idx) {
+                        const auto &r = staging[idx];
+                        this->rows[idx] = static_optable{r.opcode, r.mnemonic, r.hint, first, r.count};
+                        this->definitions[r.definition] = idx;
+                        for (std::size_t op = 0u; op < r.count; ++op) {
+                              const auto &o = written[r.first + op];
+                              this->descriptors[first] = o;
+                              this->opencodings_operands[first] = find(this->encodings, this->num_encodings, o.encoding);
+                              this->opkinds_operands[first] = find(this->kinds, this->num_kinds, o.kind);
+                              ++first;
+                        }
+                  }
+            }
+
+            constexpr std::size_t size() const {
+                  return instructions;
+            }
+
+            /* Row of opcode, npos when missing. */
+            constexpr std::size_t find(const std::intptr_t opcode) const {
+                  std::size_t low = 0u;
+                  std::size_t high = instructions;
+                  while (low < high) {
+                        const auto mid = low + (high - low) / 2u;
+                        if (this->rows[mid].opcode < opcode) {
+                              low = mid + 1u;
+                        } else {
+                              high = mid;
+                        }
+                  }
+                  return low < instructions && this->rows[low].opcode == opcode ? low : npos;
+            }
+
+            /* Opcode of mnemonic, use it in a constant expression to have a typo fail the build. */
+            constexpr std::intptr_t opcode_of(const std::string_view mnemonic) const {
+                  for (const auto &r : this->rows) {
+                        if (r.mnemonic == mnemonic) {
+                              return r.opcode;
+                        }
+                  }
+                  throw "Unknown mnemonic in static instruction set.";
+            }
+
+            /* operand_encoding enum value of encoding, npos when unused. */
+            constexpr std::size_t encoding_of(const std::string_view encoding) const {
+                  return find(this->encodings, this->num_encodings, encoding);
+            }
+
+            /* operand_kind enum value of kind, npos when unused. */
+            constexpr std::size_t kind_of(const std::string_view kind) const {
+                  return find(this->kinds, this->num_kinds, kind);
+            }
+
+            /* Opcode rows, the opencodings, opkinds and opdescriptor tables share them. */
+            std::array<static_optable, instructions> rows = {};
+
+            /* operand_encoding enum */
+            std::array<std::string_view, operands> encodings = {};
+            std::size_t num_encodings = 0u;
+
+            /* operand_kind enum */
+            std::array<std::string_view, operands> kinds = {};
+            std::size_t num_kinds = 0u;
+
+            /* Operand tables indexed by row first to first + count - 1 */
+            std::array<std::size_t, operands> opencodings_operands = {};
+            std::array<std::size_t, operands> opkinds_operands = {};
+            std::array<static_operand, operands> descriptors = {}; /* Descriptor text is operand_(hint) */
+
+            /* Row of each definition in the order they were written */
+            std::array<std::size_t, instructions> definitions = {};
+
+          private:
+            struct staged {
+                  std::intptr_t opcode = 0;
+                  std::string_view mnemonic = "";
+                  std::string_view hint = "";
+                  std::size_t first = 0u;
+                  std::size_t count = 0u;
+                  std::size_t definition = 0u;
+            };
+
+            /* Copy a definition and add its new encodings and kinds */
+            template <std::size_t operand_count>
+            constexpr void stage(const static_instruction<operand_count> &def, std::array<staged, instructions> &staging, std::array<static_operand, operands> &written, std::size_t &row, std::size_t &at) {
+                  staging[row] = staged{def.opcode, def.mnemonic, def.hint, at, operand_count, row};
+                  for (const auto &op : def.operands_) {
+                        if (find(this->encodings, this->num_encodings, op.encoding) == npos) {
+                              this->encodings[this->num_encodings++] = op.encoding;
+                        }
+                        if (find(this->kinds, this->num_kinds, op.kind) == npos) {
+                              this->kinds[this->num_kinds++] = op.kind;
+                        }
+                        written[at++] = op;
+                  }
+                  ++row;
+                  return;
+            }
+
+            static constexpr std::size_t find(const std::array<std::string_view, operands> &values, const std::size_t count, const std::string_view value) {
+                  for (std::size_t idx = 0u; idx < count; ++idx) {
+                        if (values[idx] == value) {
+                              return idx;
+                        }
+                  }
+                  return npos;
+            }
+      };
+
+      /* Build a static_set from static_instruction definitions */
+      template <std::size_t... operand_counts>
+      constexpr static_set<sizeof...(operand_counts), (operand_counts + ... + 0u)> create_static_set(const static_instruction<operand_counts> &...defs) {
+            return static_set<sizeof...(operand_counts), (operand_counts + ... + 0u)>(defs...);
+      }
+
+      /* Add every instruction of definition to set in definition order, the runtime enums then come out in the same order. */
+      template <std::size_t instructions, std::size_t operands>
+      void add_static_set(instruction_set &set, const static_set<instructions, operands> &definition) {
+            set.reserve(set.view().size() + instructions, operands);
+            for (const auto row : definition.definitions) {
+                  const auto &r = definition.rows[row];
+                  std::vector<operand> ops;
+                  ops.reserve(r.count);
+                  for (auto idx = r.first; idx < r.first + r.count; ++idx) {
+                        const auto &o = definition.descriptors[idx];
+                        ops.emplace_back(operand{std::string(o.operand_), std::string(o.encoding), std::string(o.size), std::string(o.hint), std::string(o.kind)});
+                  }
+                  set.add(r.opcode, std::string(r.mnemonic), std::string(r.hint), std::move(ops));
+            }
+            return;
+      }
+
+      /* See if the compile time tables of definition match the C++ flat tables set generates: opcodes enum values in row order,
+         the operand_encoding and operand_kind enums, each row's encodings and kinds, and the descriptor strings in row order. */
+      template <std::size_t instructions, std::size_t operands>
+      bool conforms(const static_set<instructions, operands> &definition, instruction_set &set) {
+
+            const auto code = set.represent<language::cpp, table::flat>();
+
+            /* Enumerator names and values of an emitted enum, values count up from the previous one when not written. */
+            const auto enumerators = [](const std::string &text) {
+                  std::vector<std::pair<std::string, std::intptr_t>> retn;
+                  std::istringstream lines(text);
+                  std::string line = "";
+                  std::intptr_t next = 0;
+                  while (std::getline(lines, line)) {
+                        if (line.rfind("   ", 0u) != 0u) {
+                              continue;
+                        }
+                        line = line.substr(3u, line.find("/*") == std::string::npos ? std::string::npos : line.find("/*") - 3u);
+                        line.erase(std::remove_if(line.begin(), line.end(), [](const char c) { return c == ' ' || c == ','; }), line.end());
+                        const auto equals = line.find('=');
+                        if (equals != std::string::npos) {
+                              next = static_cast<std::intptr_t>(std::stoll(line.substr(equals + 1u)));
+                              line.erase(equals);
+                        }
+                        retn.emplace_back(line, next++);
+                  }
+                  return retn;
+            };
+
+            /* Every enum::name token of text in order */
+            const auto qualified = [](const std::string &text, const std::string &name) {
+                  std::vector<std::string> retn;
+                  const auto prefix = name + "::";
+                  for (auto at = text.find(prefix); at != std::string::npos; at = text.find(prefix, at)) {
+                        at += prefix.size();
+                        const auto end = text.find_first_of(",} \n", at);
+                        retn.emplace_back(text.substr(at, end - at));
+                  }
+                  return retn;
+            };
+
+            /* Opcode rows */
+            const auto opcodes = enumerators(code.enum_opcodes);
+            if (opcodes.size() != instructions) {
+                  return false;
+            }
+            for (std::size_t row = 0u; row < instructions; ++row) {
+                  if (opcodes[row].second != definition.rows[row].opcode) {
+                        return false;
+                  }
+            }
+
+            /* Operand enums */
+            const auto same_enum = [](const std::vector<std::pair<std::string, std::intptr_t>> &emitted, const std::array<std::string_view, operands> &values, const std::size_t count) {
+                  if (emitted.size() != count) {
+                        return false;
+                  }
+                  for (std::size_t idx = 0u; idx < count; ++idx) {
+                        if (emitted[idx].first != values[idx] || emitted[idx].second != static_cast<std::intptr_t>(idx)) {
+                              return false;
+                        }
+                  }
+                  return true;
+            };
+            if (!same_enum(enumerators(code.enum_opencodings), definition.encodings, definition.num_encodings) || !same_enum(enumerators(code.enum_opkinds), definition.kinds, definition.num_kinds)) {
+                  return false;
+            }
+
+            /* Encodings and kinds of every operand in row order */
+            const auto encodings = qualified(code.opencodings, set.opencodings_enum_name);
+            const auto kinds = qualified(code.opkinds, set.opkinds_enum_name);
+            const auto used = definition.rows.empty() ? 0u : definition.rows.back().first + definition.rows.back().count;
+            if (encodings.size() != used || kinds.size() != used) {
+                  return false;
+            }
+            for (std::size_t idx = 0u; idx < used; ++idx) {
+                  if (encodings[idx] != definition.encodings[definition.opencodings_operands[idx]] || kinds[idx] != definition.kinds[definition.opkinds_operands[idx]]) {
+                        return false;
+                  }
+            }
+
+            /* Descriptor strings, rows and operands each appear in row order. */
+            std::size_t rows_at = 0u;
+            std::size_t operands_at = 0u;
+            for (std::size_t row = 0u; row < instructions; ++row) {
+                  const auto &r = definition.rows[row];
+                  const auto text = "{\"" + opcodes[row].first + "\", \"" + std::string(r.mnemonic) + "\", \"" + std::string(r.hint) + "\", ";
+                  rows_at = code.opdescriptors.find(text, rows_at);
+                  if (rows_at == std::string::npos) {
+                        return false;
+                  }
+                  rows_at += text.size();
+                  for (auto idx = r.first; idx < r.first + r.count; ++idx) {
+                        const auto &o = definition.descriptors[idx];
+                        const auto text = "\"" + std::string(o.operand_) + "(" + std::string(o.hint) + ")\"";
+                        operands_at = code.opdescriptors.find(text, std::max(operands_at, rows_at));
+                        if (operands_at == std::string::npos) {
+                              return false;
+                        }
+                        operands_at += text.size();
+                  }
+            }
+
+            return true;
+      }
+
+} // namespace iscreate
@@ -0,0 +1,137 @@
+#include "iscreate/iscreate.hpp"
+#include "iscreate/static_set.hpp"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+/* Checked in generator output, building this project compiles it as C++ and tests/encoder.c compiles it as C. */
+#include "tests/encoder.hpp"
+
+/* Interpreter handlers sum every operand, through the escaped operand names. */
+struct tests_state {
+      std::uint64_t sum;
+};
+#define INTERPRET_STATE struct tests_state
+#define INTERPRET_INT state->sum += int_;
+#define INTERPRET_MOV state->sum += register_ + signed_;
+#define INTERPRET_MOVW state->sum += std_ + size_t_ + out;
+#define INTERPRET_RETURN state->sum += size;
+#include "tests/interpreter.hpp"
+
+/* Encodes the C test sequence with the C encoders, defined in tests/encoder.c */
+extern "C" std::size_t tests_encode_c(std::uint8_t *out, std::size_t size);
+
+/* Decodes and interprets code with the C decoder and interpreter, returns the operand sum. */
+extern "C" std::uint64_t tests_interpret_c(const std::uint8_t *code, std::size_t size);
+
+namespace {
+
+      /* Names that are keywords, types the generated code uses or its own parameter names */
+      iscreate::instruction_set create_set() {
+            iscreate::instruction_set is("tests");
+            is.add<0>("nop", "Nothing operation");
+            is.add(1, "int", "Interrupt", {iscreate::create_operand("Int", "Imm", "8-Bits", "Vector", "imm")});
+            is.add(2, "mov", "Move", {iscreate::create_operand("Register", "Mod", "8-Bits", "Destination", "reg"), iscreate::create_operand("Signed", "Imm", "16-Bits", "Source", "imm")});
+            is.add(3, "movw", "Move wide", {iscreate::create_operand("std", "Mod", "8-Bits", "Destination", "reg"), iscreate::create_operand("Size_T", "Imm", "32-Bits", "Source", "imm"), iscreate::create_operand("out", "Mod", "8-Bits", "Scratch", "reg")});
+            is.add(4, "return", "Return", {iscreate::create_operand("size", "Imm", "16-Bits", "Pop", "imm")});
+            return is;
+      }
+
+      /* Header the generators write for lang */
+      template <iscreate::language lang>
+      std::string generate(iscreate::instruction_set &is) {
+            const std::string includes = lang == iscreate::language::cpp ? "#pragma once\n#include <cstddef>\n#include <cstdint>\n" : "#pragma once\n#include <stddef.h>\n#include <stdint.h>\n";
+            return includes + "\n" + is.represent_enum_opcodes<lang>() + "\n" + is.represent_encoder<lang>();
+      }
+
+      /* Decoder and interpreter for lang, they follow the enum in the encoder header. */
+      template <iscreate::language lang>
+      std::string generate_interpreter(iscreate::instruction_set &is) {
+            return "#pragma once\n\n" + is.represent_decoder<lang>() + "\n" + is.represent_interpreter<lang>();
+      }
+
+      /* Compare dir against contents, or rewrite it when updating. */
+      bool current(const std::string &dir, const std::string &contents, const bool update) {
+            if (update) {
+                  std::ofstream file(dir, std::ios::binary);
+                  file << contents;
+                  return file.good();
+            }
+            std::ifstream file(dir, std::ios::binary);
+            std::stringstream existing;
+            existing << file.rdbuf();
+            if (existing.str() != contents) {
+                  std::cerr << dir + " is out of date, run with --update and review the difference." << std::endl;
+                  return false;
+            }
+            return true;
+      }
+
+} // namespace
+
+std::int32_t main(std::int32_t argc, char **argv) {
+
+      const auto update = argc > 1 && std::string(argv[1]) == "--update";
+      std::string dir = __FILE__;
+      dir = dir.substr(0u, dir.find_last_of("/\\") + 1u) + "tests/";
+
+      std::int32_t failures = 0;
+      const auto check = [&](const bool passed, const std::string &what) {
+            if (!passed) {
+                  std::cerr << "Failed: " + what << std::endl;
+                  ++failures;
+            }
+            return;
+      };
+
+      /* The checked in headers are what the generators emit today */
+      auto is = create_set();
+      check(current(dir + "encoder.hpp", generate<iscreate::language::cpp>(is), update), "encoder.hpp matches the generator");
+      check(current(dir + "encoder.h", generate<iscreate::language::c>(is), update), "encoder.h matches the generator");
+      check(current(dir + "interpreter.hpp", generate_interpreter<iscreate::language::cpp>(is), update), "interpreter.hpp matches the generator");
+      check(current(dir + "interpreter.h", generate_interpreter<iscreate::language::c>(is), update), "interpreter.h matches the generator");
+
+      /* Escaped names call through and encode like the tables say */
+      std::uint8_t cpp[32] = {};
+      std::size_t length = 0u;
+      length += encode_nop(cpp + length, sizeof(cpp) - length);
+      length += encode_int_(cpp + length, sizeof(cpp) - length, 0x21u);
+      length += encode_mov(cpp + length, sizeof(cpp) - length, 0x01u, 0x1234u);
+      length += encode_movw(cpp + length, sizeof(cpp) - length, 0x02u, 0x11223344u, 0x03u);
+      length += encode_return_(cpp + length, sizeof(cpp) - length, 0x0008u);
+      const std::uint8_t expected[] = {0x00, 0x01, 0x21, 0x02, 0x01, 0x34, 0x12, 0x03, 0x02, 0x44, 0x33, 0x22, 0x11, 0x03, 0x04, 0x08, 0x00};
+      check(length == sizeof(expected) && std::memcmp(cpp, expected, sizeof(expected)) == 0, "C++ encoders write the expected bytes");
+
+      std::uint8_t c[32] = {};
+      check(tests_encode_c(c, sizeof(c)) == sizeof(expected) && std::memcmp(c, expected, sizeof(expected)) == 0, "C encoders write the expected bytes");
+
+      /* Escaped operand names are in scope in the handlers, every instruction runs once */
+      const std::uint64_t sum = 0x21u + 0x01u + 0x1234u + 0x02u + 0x11223344u + 0x03u + 0x0008u;
+      decoded_instruction code[8] = {};
+      std::size_t consumed = 0u;
+      const auto decoded = decode(expected, sizeof(expected), code, 8u, consumed);
+      tests_state state = {0u};
+      check(decoded == 5u && consumed == sizeof(expected) && interpret(&state, code, decoded) == 5u && state.sum == sum, "C++ interpreter runs every handler");
+      check(tests_interpret_c(expected, sizeof(expected)) == sum, "C interpreter runs every handler");
+
+      /* Compile time tables against the text represent_* generates, another add order changes the operand enums */
+      constexpr auto fixed = iscreate::create_static_set(
+          iscreate::static_instruction(2, "jmp", "Jump", iscreate::static_operand{"Target", "Rel", "32-Bits", "Offset", "imm"}),
+          iscreate::static_instruction(0, "nop", "Nothing operation"),
+          iscreate::static_instruction(1, "move", "Move", iscreate::static_operand{"Dest", "Mod", "8-Bits", "Register", "reg"}, iscreate::static_operand{"Source", "Imm", "16-Bits", "Integer", "imm"}));
+      iscreate::instruction_set loaded("loaded");
+      iscreate::add_static_set(loaded, fixed);
+      check(iscreate::conforms(fixed, loaded), "static set conforms to the set it was added to");
+      iscreate::instruction_set reordered("reordered");
+      reordered.add<0>("nop", "Nothing operation");
+      reordered.add(1, "move", "Move", {iscreate::create_operand("Dest", "Mod", "8-Bits", "Register", "reg"), iscreate::create_operand("Source", "Imm", "16-Bits", "Integer", "imm")});
+      reordered.add(2, "jmp", "Jump", {iscreate::create_operand("Target", "Rel", "32-Bits", "Offset", "imm")});
+      check(!iscreate::conforms(fixed, reordered), "static set does not conform to other operand enums");
+
+      std::cout << (failures == 0 ? "All tests passed." : std::to_string(failures) + " tests failed.") << std::endl;
+
+      return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,35 @@
+#include "encoder.h"
+
+/* Same handlers as tests.cpp */
+struct tests_state {
+      uint64_t sum;
+};
+#define INTERPRET_STATE struct tests_state
+#define INTERPRET_INT state->sum += int_;
+#define INTERPRET_MOV state->sum += register_ + signed_;
+#define INTERPRET_MOVW state->sum += std_ + size_t_ + out;
+#define INTERPRET_RETURN state->sum += size;
+#include "interpreter.h"
+
+/* Same sequence as tests.cpp through the C encoders */
+size_t tests_encode_c(uint8_t *out, size_t size) {
+      size_t length = 0u;
+      length += encode_nop(out + length, size - length);
+      length += encode_int_(out + length, size - length, 0x21u);
+      length += encode_mov(out + length, size - length, 0x01u, 0x1234u);
+      length += encode_movw(out + length, size - length, 0x02u, 0x11223344u, 0x03u);
+      length += encode_return_(out + length, size - length, 0x0008u);
+      return length;
+}
+
+/* Decode and run code through the C interpreter, returns the operand sum or 0 when not all of it decodes. */
+uint64_t tests_interpret_c(const uint8_t *code, size_t size) {
+      decoded_instruction decoded[8];
+      size_t consumed = 0u;
+      struct tests_state state = {0u};
+      const size_t count = decode(code, size, decoded, 8u, &consumed);
+      if (consumed != size || interpret(&state, decoded, count) != count) {
+            return 0u;
+      }
+      return state.sum;
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+   OP_NOP, /* (0) | Nothing operation */
+   OP_INT, /* (1) | Interrupt | * Int(8-Bits) */
+   OP_MOV, /* (2) | Move | * Register(8-Bits), * Signed(16-Bits) */
+   OP_MOVW, /* (3) | Move wide | * std(8-Bits), * Size_T(32-Bits), * out(8-Bits) */
+   OP_RETURN /* (4) | Return | * size(16-Bits) */
+} opcodes;
+/* Encode nop, returns bytes written or 0 when it does not fit. */
+static inline size_t encode_nop(uint8_t *out, size_t size) {
+   if (size < 1u) {
+      return 0u;
+   }
+   out[0] = 0u;
+   return 1u;
+}
+/* Encode int, returns bytes written or 0 when it does not fit. */
+static inline size_t encode_int_(uint8_t *out, size_t size, uint8_t int_) {
+   if (size < 2u) {
+      return 0u;
+   }
+   out[0] = 1u;
+   out[1] = (uint8_t)(int_);
+   return 2u;
+}
+/* Encode mov, returns bytes written or 0 when it does not fit. */
+static inline size_t encode_mov(uint8_t *out, size_t size, uint8_t register_, uint16_t signed_) {
+   if (size < 4u) {
+      return 0u;
+   }
+   out[0] = 2u;
+   out[1] = (uint8_t)(register_);
+   out[2] = (uint8_t)(signed_);
+   out[3] = (uint8_t)(signed_ >> 8u);
+   return 4u;
+}
+/* Encode movw, returns bytes written or 0 when it does not fit. */
+static inline size_t encode_movw(uint8_t *out, size_t size, uint8_t std_, uint32_t size_t_, uint8_t out_2) {
+   if (size < 7u) {
+      return 0u;
+   }
+   out[0] = 3u;
+   out[1] = (uint8_t)(std_);
+   out[2] = (uint8_t)(size_t_);
+   out[3] = (uint8_t)(size_t_ >> 8u);
+   out[4] = (uint8_t)(size_t_ >> 16u);
+   out[5] = (uint8_t)(size_t_ >> 24u);
+   out[6] = (uint8_t)(out_2);
+   return 7u;
+}
+/* Encode return, returns bytes written or 0 when it does not fit. */
+static inline size_t encode_return_(uint8_t *out, size_t size, uint16_t size_0) {
+   if (size < 3u) {
+      return 0u;
+   }
+   out[0] = 4u;
+   out[1] = (uint8_t)(size_0);
+   out[2] = (uint8_t)(size_0 >> 8u);
+   return 3u;
+}
+typedef struct {
+   opcodes op;
+   uint64_t operands[3];
+} encode_record;
+static const uint8_t encode_lengths[5] = {
+   1, /* nop */
+   2, /* int */
+   4, /* mov */
+   7, /* movw */
+   3 /* return */
+};
+static const uint8_t encode_widths[5][3] = {
+   {0, 0, 0}, /* nop */
+   {1, 0, 0}, /* int */
+   {1, 2, 0}, /* mov */
+   {1, 4, 1}, /* movw */
+   {2, 0, 0} /* return */
+};
+/* Encode up to count records, stops early on an unknown opcode or a full buffer. */
+static inline size_t encode(const encode_record *records, size_t count, uint8_t *out, size_t size, size_t *written) {
+   size_t offset = 0u;
+   size_t n = 0u;
+   for (; n < count; ++n) {
+      const size_t op = (size_t)records[n].op;
+      const size_t length = op < 5u ? encode_lengths[op] : 0u;
+      if (length == 0u || size - offset < length) {
+         break;
+      }
+      uint8_t *p = out + offset;
+      p[0] = (uint8_t)(op);
+      p += 1u;
+      for (size_t k = 0u; k < 3u; ++k) {
+         const size_t width = encode_widths[op][k];
+         const uint64_t value = records[n].operands[k];
+         for (size_t b = 0u; b < width; ++b) {
+            p[b] = (uint8_t)(value >> (8u * b));
+         }
+         p += width;
+      }
+      offset += length;
+   }
+   *written = offset;
+   return n;
+}
\ No newline at end of file
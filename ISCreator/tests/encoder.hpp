@@ -0,0 +1,107 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+enum class opcodes {
+   OP_NOP, /* (0) | Nothing operation */
+   OP_INT, /* (1) | Interrupt | * Int(8-Bits) */
+   OP_MOV, /* (2) | Move | * Register(8-Bits), * Signed(16-Bits) */
+   OP_MOVW, /* (3) | Move wide | * std(8-Bits), * Size_T(32-Bits), * out(8-Bits) */
+   OP_RETURN /* (4) | Return | * size(16-Bits) */
+};
+/* Encode nop, returns bytes written or 0 when it does not fit. */
+static inline std::size_t encode_nop(std::uint8_t *out, std::size_t size) {
+   if (size < 1u) {
+      return 0u;
+   }
+   out[0] = 0u;
+   return 1u;
+}
+/* Encode int, returns bytes written or 0 when it does not fit. */
+static inline std::size_t encode_int_(std::uint8_t *out, std::size_t size, std::uint8_t int_) {
+   if (size < 2u) {
+      return 0u;
+   }
+   out[0] = 1u;
+   out[1] = static_cast<std::uint8_t>(int_);
+   return 2u;
+}
+/* Encode mov, returns bytes written or 0 when it does not fit. */
+static inline std::size_t encode_mov(std::uint8_t *out, std::size_t size, std::uint8_t register_, std::uint16_t signed_) {
+   if (size < 4u) {
+      return 0u;
+   }
+   out[0] = 2u;
+   out[1] = static_cast<std::uint8_t>(register_);
+   out[2] = static_cast<std::uint8_t>(signed_);
+   out[3] = static_cast<std::uint8_t>(signed_ >> 8u);
+   return 4u;
+}
+/* Encode movw, returns bytes written or 0 when it does not fit. */
+static inline std::size_t encode_movw(std::uint8_t *out, std::size_t size, std::uint8_t std_, std::uint32_t size_t_, std::uint8_t out_2) {
+   if (size < 7u) {
+      return 0u;
+   }
+   out[0] = 3u;
+   out[1] = static_cast<std::uint8_t>(std_);
+   out[2] = static_cast<std::uint8_t>(size_t_);
+   out[3] = static_cast<std::uint8_t>(size_t_ >> 8u);
+   out[4] = static_cast<std::uint8_t>(size_t_ >> 16u);
+   out[5] = static_cast<std::uint8_t>(size_t_ >> 24u);
+   out[6] = static_cast<std::uint8_t>(out_2);
+   return 7u;
+}
+/* Encode return, returns bytes written or 0 when it does not fit. */
+static inline std::size_t encode_return_(std::uint8_t *out, std::size_t size, std::uint16_t size_0) {
+   if (size < 3u) {
+      return 0u;
+   }
+   out[0] = 4u;
+   out[1] = static_cast<std::uint8_t>(size_0);
+   out[2] = static_cast<std::uint8_t>(size_0 >> 8u);
+   return 3u;
+}
+struct encode_record {
+   opcodes op;
+   std::uint64_t operands[3];
+};
+static constexpr std::uint8_t encode_lengths[5] = {
+   1, /* nop */
+   2, /* int */
+   4, /* mov */
+   7, /* movw */
+   3 /* return */
+};
+static constexpr std::uint8_t encode_widths[5][3] = {
+   {0, 0, 0}, /* nop */
+   {1, 0, 0}, /* int */
+   {1, 2, 0}, /* mov */
+   {1, 4, 1}, /* movw */
+   {2, 0, 0} /* return */
+};
+/* Encode up to count records, stops early on an unknown opcode or a full buffer. */
+static inline std::size_t encode(const encode_record *records, std::size_t count, std::uint8_t *out, std::size_t size, std::size_t &written) {
+   std::size_t offset = 0u;
+   std::size_t n = 0u;
+   for (; n < count; ++n) {
+      const std::size_t op = (std::size_t)records[n].op;
+      const std::size_t length = op < 5u ? encode_lengths[op] : 0u;
+      if (length == 0u || size - offset < length) {
+         break;
+      }
+      std::uint8_t *p = out + offset;
+      p[0] = static_cast<std::uint8_t>(op);
+      p += 1u;
+      for (std::size_t k = 0u; k < 3u; ++k) {
+         const std::size_t width = encode_widths[op][k];
+         const std::uint64_t value = records[n].operands[k];
+         for (std::size_t b = 0u; b < width; ++b) {
+            p[b] = static_cast<std::uint8_t>(value >> (8u * b));
+         }
+         p += width;
+      }
+      offset += length;
+   }
+   written = offset;
+   return n;
+}
\ No newline at end of file
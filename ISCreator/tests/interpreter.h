@@ -0,0 +1,836 @@
+#pragma once
+
+typedef struct {
+   opcodes op;
+   uint8_t length;
+   uint64_t operands[3];
+} decoded_instruction;
+static const uint8_t decode_lengths[256] = {
+   1, /* nop */
+   2, /* int */
+   4, /* mov */
+   7, /* movw */
+   3, /* return */
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0,
+   0
+};
+static const uint8_t decode_widths[256][3] = {
+   {0, 0, 0}, /* nop */
+   {1, 0, 0}, /* int */
+   {1, 2, 0}, /* mov */
+   {1, 4, 1}, /* movw */
+   {2, 0, 0}, /* return */
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0},
+   {0, 0, 0}
+};
+/* Decode up to count instructions, stops early on an unknown opcode or truncated instruction. */
+static inline size_t decode(const uint8_t *code, size_t size, decoded_instruction *out, size_t count, size_t *consumed) {
+   size_t offset = 0u;
+   size_t n = 0u;
+   for (; n < count && size - offset >= 1u; ++n) {
+      const size_t op = code[offset];
+      const size_t length = decode_lengths[op];
+      if (length == 0u || size - offset < length) {
+         break;
+      }
+      const uint8_t *p = code + offset + 1u;
+      out[n].op = (opcodes)op;
+      out[n].length = (uint8_t)length;
+      for (size_t k = 0u; k < 3u; ++k) {
+         const size_t width = decode_widths[op][k];
+         uint64_t value = 0u;
+         for (size_t b = 0u; b < width && b < 8u; ++b) {
+            value |= (uint64_t)p[b] << (8u * b);
+         }
+         out[n].operands[k] = value;
+         p += width;
+      }
+      offset += length;
+   }
+   *consumed = offset;
+   return n;
+}
+/* Interpreter over decoded instructions. Define INTERPRET_<MNEMONIC> to give a handler its body, it runs with state, ip,
+   next (ip + 1, may be changed to jump or set to null to stop) and one const per operand in scope. INTERPRET_DISPATCH picks
+   tail calls (2), computed goto (1) or switch (0), by default the fastest the compiler supports. */
+#ifndef INTERPRET_STATE
+#define INTERPRET_STATE void
+#endif
+#ifndef INTERPRET_NOP
+#define INTERPRET_NOP
+#endif
+#ifndef INTERPRET_INT
+#define INTERPRET_INT
+#endif
+#ifndef INTERPRET_MOV
+#define INTERPRET_MOV
+#endif
+#ifndef INTERPRET_MOVW
+#define INTERPRET_MOVW
+#endif
+#ifndef INTERPRET_RETURN
+#define INTERPRET_RETURN
+#endif
+#if !defined(INTERPRET_DISPATCH) && defined(__clang__) && defined(__has_attribute)
+#if __has_attribute(musttail)
+#define INTERPRET_DISPATCH 2
+#endif
+#endif
+#if !defined(INTERPRET_DISPATCH) && (defined(__GNUC__) || defined(__clang__))
+#define INTERPRET_DISPATCH 1
+#endif
+#ifndef INTERPRET_DISPATCH
+#define INTERPRET_DISPATCH 0
+#endif
+#if INTERPRET_DISPATCH == 2
+#if defined(__clang__) && defined(__has_attribute)
+#if __has_attribute(musttail)
+#define INTERPRET_MUSTTAIL __attribute__((musttail))
+#endif
+#endif
+#ifndef INTERPRET_MUSTTAIL
+#define INTERPRET_MUSTTAIL
+#endif
+typedef size_t (*interpret_handler)(INTERPRET_STATE *state, const decoded_instruction *ip, const decoded_instruction *end, size_t executed);
+static size_t interpret_unknown(INTERPRET_STATE *state, const decoded_instruction *ip, const decoded_instruction *end, size_t executed) {
+   (void)state;
+   (void)ip;
+   (void)end;
+   return executed;
+}
+static size_t interpret_NOP(INTERPRET_STATE *state, const decoded_instruction *ip, const decoded_instruction *end, size_t executed);
+static size_t interpret_INT(INTERPRET_STATE *state, const decoded_instruction *ip, const decoded_instruction *end, size_t executed);
+static size_t interpret_MOV(INTERPRET_STATE *state, const decoded_instruction *ip, const decoded_instruction *end, size_t executed);
+static size_t interpret_MOVW(INTERPRET_STATE *state, const decoded_instruction *ip, const decoded_instruction *end, size_t executed);
+static size_t interpret_RETURN(INTERPRET_STATE *state, const decoded_instruction *ip, const decoded_instruction *end, size_t executed);
+static const interpret_handler interpret_handlers[6] = {
+   interpret_NOP,
+   interpret_INT,
+   interpret_MOV,
+   interpret_MOVW,
+   interpret_RETURN,
+   interpret_unknown
+};
+static size_t interpret_NOP(INTERPRET_STATE *state, const decoded_instruction *ip, const decoded_instruction *end, size_t executed) {
+   const decoded_instruction *next = ip + 1;
+   {
+      INTERPRET_NOP
+   }
+   if (next == NULL || next >= end) {
+      return executed + 1u;
+   }
+   INTERPRET_MUSTTAIL return interpret_handlers[(size_t)next->op < 5u ? (size_t)next->op : 5u](state, next, end, executed + 1u);
+}
+static size_t interpret_INT(INTERPRET_STATE *state, const decoded_instruction *ip, const decoded_instruction *end, size_t executed) {
+   const decoded_instruction *next = ip + 1;
+   {
+      const uint64_t int_ = ip->operands[0];
+      (void)int_;
+      INTERPRET_INT
+   }
+   if (next == NULL || next >= end) {
+      return executed + 1u;
+   }
+   INTERPRET_MUSTTAIL return interpret_handlers[(size_t)next->op < 5u ? (size_t)next->op : 5u](state, next, end, executed + 1u);
+}
+static size_t interpret_MOV(INTERPRET_STATE *state, const decoded_instruction *ip, const decoded_instruction *end, size_t executed) {
+   const decoded_instruction *next = ip + 1;
+   {
+      const uint64_t register_ = ip->operands[0];
+      const uint64_t signed_ = ip->operands[1];
+      (void)register_;
+      (void)signed_;
+      INTERPRET_MOV
+   }
+   if (next == NULL || next >= end) {
+      return executed + 1u;
+   }
+   INTERPRET_MUSTTAIL return interpret_handlers[(size_t)next->op < 5u ? (size_t)next->op : 5u](state, next, end, executed + 1u);
+}
+static size_t interpret_MOVW(INTERPRET_STATE *state, const decoded_instruction *ip, const decoded_instruction *end, size_t executed) {
+   const decoded_instruction *next = ip + 1;
+   {
+      const uint64_t std_ = ip->operands[0];
+      const uint64_t size_t_ = ip->operands[1];
+      const uint64_t out = ip->operands[2];
+      (void)std_;
+      (void)size_t_;
+      (void)out;
+      INTERPRET_MOVW
+   }
+   if (next == NULL || next >= end) {
+      return executed + 1u;
+   }
+   INTERPRET_MUSTTAIL return interpret_handlers[(size_t)next->op < 5u ? (size_t)next->op : 5u](state, next, end, executed + 1u);
+}
+static size_t interpret_RETURN(INTERPRET_STATE *state, const decoded_instruction *ip, const decoded_instruction *end, size_t executed) {
+   const decoded_instruction *next = ip + 1;
+   {
+      const uint64_t size = ip->operands[0];
+      (void)size;
+      INTERPRET_RETURN
+   }
+   if (next == NULL || next >= end) {
+      return executed + 1u;
+   }
+   INTERPRET_MUSTTAIL return interpret_handlers[(size_t)next->op < 5u ? (size_t)next->op : 5u](state, next, end, executed + 1u);
+}
+/* Run count decoded instructions from code, returns how many ran. */
+static inline size_t interpret(INTERPRET_STATE *state, const decoded_instruction *code, size_t count) {
+   if (count == 0u) {
+      return 0u;
+   }
+   return interpret_handlers[(size_t)code->op < 5u ? (size_t)code->op : 5u](state, code, code + count, 0u);
+}
+#elif INTERPRET_DISPATCH == 1
+/* Run count decoded instructions from code, returns how many ran. */
+static inline size_t interpret(INTERPRET_STATE *state, const decoded_instruction *code, size_t count) {
+   static void *const labels[6] = {
+      &&interpret_NOP,
+      &&interpret_INT,
+      &&interpret_MOV,
+      &&interpret_MOVW,
+      &&interpret_RETURN,
+      &&interpret_unknown};
+   const decoded_instruction *ip = code;
+   const decoded_instruction *end = code + count;
+   const decoded_instruction *next = code;
+   size_t executed = 0u;
+   (void)state;
+   if (count == 0u) {
+      return 0u;
+   }
+   goto *labels[(size_t)ip->op < 5u ? (size_t)ip->op : 5u];
+interpret_NOP: {
+      next = ip + 1;
+      {
+         INTERPRET_NOP
+      }
+      ++executed;
+      if (next == NULL || next >= end) {
+         return executed;
+      }
+      ip = next;
+      goto *labels[(size_t)ip->op < 5u ? (size_t)ip->op : 5u];
+   }
+interpret_INT: {
+      next = ip + 1;
+      {
+         const uint64_t int_ = ip->operands[0];
+         (void)int_;
+         INTERPRET_INT
+      }
+      ++executed;
+      if (next == NULL || next >= end) {
+         return executed;
+      }
+      ip = next;
+      goto *labels[(size_t)ip->op < 5u ? (size_t)ip->op : 5u];
+   }
+interpret_MOV: {
+      next = ip + 1;
+      {
+         const uint64_t register_ = ip->operands[0];
+         const uint64_t signed_ = ip->operands[1];
+         (void)register_;
+         (void)signed_;
+         INTERPRET_MOV
+      }
+      ++executed;
+      if (next == NULL || next >= end) {
+         return executed;
+      }
+      ip = next;
+      goto *labels[(size_t)ip->op < 5u ? (size_t)ip->op : 5u];
+   }
+interpret_MOVW: {
+      next = ip + 1;
+      {
+         const uint64_t std_ = ip->operands[0];
+         const uint64_t size_t_ = ip->operands[1];
+         const uint64_t out = ip->operands[2];
+         (void)std_;
+         (void)size_t_;
+         (void)out;
+         INTERPRET_MOVW
+      }
+      ++executed;
+      if (next == NULL || next >= end) {
+         return executed;
+      }
+      ip = next;
+      goto *labels[(size_t)ip->op < 5u ? (size_t)ip->op : 5u];
+   }
+interpret_RETURN: {
+      next = ip + 1;
+      {
+         const uint64_t size = ip->operands[0];
+         (void)size;
+         INTERPRET_RETURN
+      }
+      ++executed;
+      if (next == NULL || next >= end) {
+         return executed;
+      }
+      ip = next;
+      goto *labels[(size_t)ip->op < 5u ? (size_t)ip->op : 5u];
+   }
+interpret_unknown:
+   return executed;
+}
+#else
+/* Run count decoded instructions from code, returns how many ran. */
+static inline size_t interpret(INTERPRET_STATE *state, const decoded_instruction *code, size_t count) {
+   const decoded_instruction *ip = code;
+   const decoded_instruction *end = code + count;
+   size_t executed = 0u;
+   (void)state;
+   while (ip != NULL && ip < end) {
+      const decoded_instruction *next = ip + 1;
+      switch (ip->op) {
+         case OP_NOP:
+         {
+            INTERPRET_NOP
+         }
+         break;
+         case OP_INT:
+         {
+            const uint64_t int_ = ip->operands[0];
+            (void)int_;
+            INTERPRET_INT
+         }
+         break;
+         case OP_MOV:
+         {
+            const uint64_t register_ = ip->operands[0];
+            const uint64_t signed_ = ip->operands[1];
+            (void)register_;
+            (void)signed_;
+            INTERPRET_MOV
+         }
+         break;
+         case OP_MOVW:
+         {
+            const uint64_t std_ = ip->operands[0];
+            const uint64_t size_t_ = ip->operands[1];
+            const uint64_t out = ip->operands[2];
+            (void)std_;
+            (void)size_t_;
+            (void)out;
+            INTERPRET_MOVW
+         }
+         break;
+         case OP_RETURN:
+         {
+            const uint64_t size = ip->operands[0];
+            (void)size;
+            INTERPRET_RETURN
+         }
+         break;
+         default:
+            return executed;
+      }
+      ++executed;
+      ip = next;
+   }
+   return executed;
+}
+#endif
\ No newline at end of file